@@ -2,6 +2,8 @@
 """
 Benchmark FFTW implementation with optimal thread count selection
 Takes median of 5 runs for each test case
+
+Usage: benchmark_fftw.py [--threading]   (--threading: only the OpenMP/pthreads scaling sweep)
 """
 
 import subprocess
@@ -24,18 +26,73 @@ test_cases = [
     (250, 524288),  # 512K FFT
 ]
 
+# Non-power-of-two lengths: 7-smooth sizes and primes. Kept in a separate
+# CSV so the backend comparison scripts still line up row by row.
+non_pow2_cases = [
+    (1000, 1000),   # 2^3·5^3
+    (1000, 1536),   # 2^9·3
+    (1000, 3000),   # 2^3·3·5^3
+    (1000, 1009),   # prime
+    (1000, 4099),   # prime
+    (250, 65537),   # Fermat prime
+    (250, 100003),  # prime
+]
+
+# Tiny transforms in huge batches (channelizer outputs), where transforms/sec
+# matters more than GFLOPS; batch mode may pick the vertical kernel here
+small_cases = [
+    (1000000, 8),
+    (1000000, 16),
+    (500000, 32),
+    (250000, 64),
+    (125000, 128),
+]
+
+# Large transforms, where cpp_fftw_results.csv drops below 25 GFLOPS: FFTW
+# against the cache-blocked four-step with a full twiddle table and with
+# twiddles generated by a reseeded recurrence
+large_cases = [
+    (250, 131072),
+    (250, 262144),
+    (250, 524288),
+]
+large_methods = ['fftw', 'fourstep_table', 'fourstep']
+
+# OpenMP against pthreads scaling: every thread count, not just the best,
+# for both --parallel settings, on the default build and on a second one
+# configured with -DBATCH_FFT_OPENMP=OFF in build-pthreads
+threading_cases = [
+    (10000, 1024),
+    (1000, 16384),
+    (100000, 64),
+]
+threading_builds = [
+    ('openmp', './build/batch_fft'),
+    ('pthreads', './build-pthreads/batch_fft'),
+]
+threading_parallel = ['fftw', 'batch']
+
 thread_counts = [1, 2, 4, 8]
 NUM_RUNS = 5
 
-def run_benchmark(batch, length, threads):
+def run_benchmark(batch, length, threads, method=None, parallel=None, binary='./build/batch_fft'):
     """Run benchmark NUM_RUNS times and return median result"""
     try:
         times = []
         gflops_values = []
+        rates = []
+        methods = []
+        backend = None
+
+        cmd = [binary, '-b', str(batch), '-l', str(length), '-t', str(threads)]
+        if method:
+            cmd += ['--method', method]
+        if parallel:
+            cmd += ['--parallel', parallel]
 
         for _ in range(NUM_RUNS):
             result = subprocess.run(
-                ['./build/batch_fft', '-b', str(batch), '-l', str(length), '-t', str(threads)],
+                cmd,
                 capture_output=True,
                 text=True,
                 timeout=60
@@ -45,6 +102,11 @@ def run_benchmark(batch, length, threads):
                 print(f"Error running benchmark: {result.stderr}", file=sys.stderr)
                 continue
 
+            # The build's threading backend, as logged on stderr
+            for line in result.stderr.split('\n'):
+                if line.startswith('threading: '):
+                    backend = line.split()[1].rstrip(',')
+
             # Parse CSV output (skip header)
             lines = result.stdout.strip().split('\n')
             if len(lines) < 2:
@@ -53,6 +115,8 @@ def run_benchmark(batch, length, threads):
             data = lines[1].split(',')
             times.append(float(data[3]))
             gflops_values.append(float(data[4]))
+            methods.append(data[5])
+            rates.append(float(data[6]))
 
         if not times:
             return None
@@ -66,7 +130,10 @@ def run_benchmark(batch, length, threads):
             'fft_length': length,
             'threads': threads,
             'time_ms': median_time,
-            'gflops': median_gflops
+            'gflops': median_gflops,
+            'method': max(set(methods), key=methods.count),
+            'transforms_per_sec': statistics.median(rates),
+            'backend': backend
         }
     except subprocess.TimeoutExpired:
         print(f"Timeout for batch={batch}, length={length}, threads={threads}", file=sys.stderr)
@@ -75,7 +142,7 @@ def run_benchmark(batch, length, threads):
         print(f"Exception: {e}", file=sys.stderr)
         return None
 
-def find_best_thread_count(batch, length):
+def find_best_thread_count(batch, length, method=None):
     """Find the optimal thread count for a given test case"""
     best_result = None
     best_gflops = 0
@@ -83,7 +150,7 @@ def find_best_thread_count(batch, length):
     print(f"Testing FFT size={length}, batch={batch}...", file=sys.stderr)
 
     for threads in thread_counts:
-        result = run_benchmark(batch, length, threads)
+        result = run_benchmark(batch, length, threads, method)
         if result is None:
             continue
 
@@ -99,31 +166,116 @@ def find_best_thread_count(batch, length):
 
     return best_result
 
+def run_threading_sweep():
+    """Every thread count x --parallel setting on both builds, for scaling curves"""
+    results = []
+    for label, binary in threading_builds:
+        print(f"Build {label} ({binary})...", file=sys.stderr)
+        for batch, length in threading_cases:
+            for parallel in threading_parallel:
+                for threads in thread_counts:
+                    result = run_benchmark(batch, length, threads, 'fftw', parallel, binary)
+                    if result is None:
+                        continue
+                    if result['backend'] != label:
+                        print(f"  {binary} reports threading: {result['backend']}, expected {label}",
+                              file=sys.stderr)
+                    result['build'] = label
+                    result['parallel'] = parallel
+                    print(f"  {length} x {batch}, --parallel {parallel}, {threads}T: "
+                          f"{result['time_ms']:.2f} ms, {result['gflops']:.1f} GFLOPS", file=sys.stderr)
+                    results.append(result)
+
+    threading_file = 'fftw_results_threading_f32.csv'
+    with open(threading_file, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=['build', 'batch', 'fft_length', 'parallel', 'threads',
+                                               'time_ms', 'gflops', 'transforms_per_sec'],
+                                extrasaction='ignore')
+        writer.writeheader()
+        writer.writerows(results)
+    print(f"\nResults written to {threading_file}", file=sys.stderr)
+
 def main():
+    if '--threading' in sys.argv[1:]:
+        run_threading_sweep()
+        return
+
     print("FFTW Batch FFT Benchmark (Single Precision) - Finding optimal configurations", file=sys.stderr)
     print("=" * 60, file=sys.stderr)
 
     results = []
 
+    # Plain FFTW, not the fixed-length kernels batch mode picks for some
+    # of these lengths, so the rows compare library against library
     for batch, length in test_cases:
-        result = find_best_thread_count(batch, length)
+        result = find_best_thread_count(batch, length, 'fftw')
         if result:
             results.append(result)
 
+    non_pow2_results = []
+    for batch, length in non_pow2_cases:
+        result = find_best_thread_count(batch, length)
+        if result:
+            non_pow2_results.append(result)
+
+    small_results = []
+    for batch, length in small_cases:
+        result = find_best_thread_count(batch, length)
+        if result:
+            small_results.append(result)
+
+    large_results = []
+    for batch, length in large_cases:
+        for method in large_methods:
+            result = find_best_thread_count(batch, length, method)
+            if result:
+                large_results.append(result)
+
     # Write results to CSV
     output_file = 'fftw_results_f32.csv'
     with open(output_file, 'w', newline='') as f:
-        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops'])
+        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops'],
+                                extrasaction='ignore')
         writer.writeheader()
         writer.writerows(results)
 
-    print(f"\nResults written to {output_file}", file=sys.stderr)
+    non_pow2_file = 'fftw_results_nonpow2_f32.csv'
+    with open(non_pow2_file, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops'],
+                                extrasaction='ignore')
+        writer.writeheader()
+        writer.writerows(non_pow2_results)
+
+    small_file = 'fftw_results_small_f32.csv'
+    with open(small_file, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops',
+                                               'method', 'transforms_per_sec'])
+        writer.writeheader()
+        writer.writerows(small_results)
+
+    large_file = 'fftw_results_large_f32.csv'
+    with open(large_file, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops', 'method'],
+                                extrasaction='ignore')
+        writer.writeheader()
+        writer.writerows(large_results)
+
+    print(f"\nResults written to {output_file}, {non_pow2_file}, {small_file} and {large_file}", file=sys.stderr)
     print("\nSummary:", file=sys.stderr)
     print("-" * 60, file=sys.stderr)
 
-    for r in results:
-        size_str = f"{r['fft_length']//1024}K" if r['fft_length'] >= 1024 else str(r['fft_length'])
-        print(f"FFT {size_str:>5} × {r['batch']:>5}: {r['threads']}T, {r['time_ms']:>7.2f}ms, {r['gflops']:>4.0f} GFLOPS", file=sys.stderr)
+    for r in results + non_pow2_results:
+        length = r['fft_length']
+        size_str = f"{length//1024}K" if length >= 1024 and length % 1024 == 0 else str(length)
+        print(f"FFT {size_str:>6} × {r['batch']:>5}: {r['threads']}T, {r['time_ms']:>7.2f}ms, {r['gflops']:>4.0f} GFLOPS", file=sys.stderr)
+
+    for r in small_results:
+        print(f"FFT {r['fft_length']:>6} × {r['batch']:>7}: {r['threads']}T, {r['time_ms']:>7.2f}ms, "
+              f"{r['transforms_per_sec'] / 1e6:>6.1f}M transforms/s ({r['method']})", file=sys.stderr)
+
+    for r in large_results:
+        print(f"FFT {r['fft_length'] // 1024:>5}K × {r['batch']:>5}: {r['threads']}T, {r['time_ms']:>7.2f}ms, "
+              f"{r['gflops']:>4.0f} GFLOPS ({r['method']})", file=sys.stderr)
 
 if __name__ == '__main__':
     main()
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+"""
+Benchmark the FFTW processing modes (stft, ...) with optimal thread count selection
+Takes median of 5 runs for each test case
+
+Usage: benchmark_modes.py [mode ...]   (default: all modes)
+"""
+
+import subprocess
+import csv
+import sys
+import statistics
+
+# Per mode: the column to maximize and the test cases (extra command-line arguments)
+MODES = {
+    'batch': {
+        'metric': 'gflops',
+        'cases': [
+            # 2D/3D stacks (-d); the per-axis 1D baseline time is in each row
+            ['-b', '64', '-d', '512x512'],
+            ['-b', '64', '-d', '512x512', '--method', 'fftw'],
+            ['-b', '1000', '-d', '64x64'],
+            ['-b', '16', '-d', '128x128x128'],
+            ['-b', '16', '-d', '128x128x128', '--method', 'fftw'],
+        ],
+    },
+    'stft': {
+        'metric': 'frames_per_sec',
+        'cases': [
+            # (length, hop) pairs common for spectrograms: 50% and 75% overlap
+            ['-b', '10000', '-l', '256', '--hop', '128'],
+            ['-b', '10000', '-l', '256', '--hop', '64'],
+            ['-b', '5000', '-l', '1024', '--hop', '512'],
+            ['-b', '5000', '-l', '1024', '--hop', '256'],
+            ['-b', '5000', '-l', '1024', '--hop', '256', '--window', 'hann'],
+            ['-b', '2000', '-l', '4096', '--hop', '2048'],
+            ['-b', '2000', '-l', '4096', '--hop', '1024'],
+            ['-b', '2000', '-l', '4096', '--hop', '1024', '--window', 'hann'],
+        ],
+    },
+    'welch': {
+        'metric': 'frames_per_sec',
+        'cases': [
+            # Hundreds of 50%-overlap Hann frames averaged per channel
+            ['-c', '64', '-b', '500', '-l', '1024', '--hop', '512', '--window', 'hann'],
+            ['-c', '16', '-b', '500', '-l', '4096', '--hop', '2048', '--window', 'hann'],
+            ['-c', '4', '-b', '200', '-l', '16384', '--hop', '8192', '--window', 'hann'],
+        ],
+    },
+    'conv': {
+        'metric': 'samples_per_sec',
+        'cases': [
+            # FIR filtering across tap counts; direct convolution rate is in each row
+            ['-b', '64', '-l', '1000000', '--taps', '1024'],
+            ['-b', '64', '-l', '1000000', '--taps', '4096'],
+            ['-b', '64', '-l', '1000000', '--taps', '16384'],
+            ['-b', '64', '-l', '1000000', '--taps', '65536'],
+            ['-b', '64', '-l', '1000000', '--taps', '1024', '--method', 'add'],
+            ['-b', '64', '-l', '1000000', '--taps', '65536', '--method', 'add'],
+        ],
+    },
+    'xcorr': {
+        'metric': 'pairs_per_sec',
+        'cases': [
+            # Signal pairs vs. one reference against many, full output vs. peaks only
+            ['-b', '10000', '-l', '1024'],
+            ['-b', '10000', '-l', '1024', '--peaks'],
+            ['-b', '10000', '-l', '1024', '--reference'],
+            ['-b', '10000', '-l', '1024', '--reference', '--peaks'],
+            ['-b', '1000', '-l', '16384', '--peaks'],
+            ['-b', '1000', '-l', '16384', '--reference', '--peaks'],
+        ],
+    },
+    'radar': {
+        'metric': 'cpis_per_sec',
+        'cases': [
+            # (pulses, range samples) per CPI, corner turn vs. strided Doppler FFT
+            ['-c', '8', '-b', '128', '-l', '4096'],
+            ['-c', '8', '-b', '128', '-l', '4096', '--method', 'strided'],
+            ['-c', '8', '-b', '512', '-l', '8192'],
+            ['-c', '8', '-b', '512', '-l', '8192', '--method', 'strided'],
+            ['-c', '4', '-b', '1024', '-l', '16384'],
+            ['-c', '4', '-b', '1024', '-l', '16384', '--method', 'strided'],
+        ],
+    },
+    'pfb': {
+        'metric': 'msamples_per_sec',
+        'cases': [
+            # (channels, taps per branch), fused FIR + FFT vs. two passes
+            ['-c', '16', '-b', '2000', '-l', '256', '--taps', '8'],
+            ['-c', '16', '-b', '2000', '-l', '256', '--taps', '8', '--method', 'separate'],
+            ['-c', '16', '-b', '2000', '-l', '1024', '--taps', '8'],
+            ['-c', '16', '-b', '2000', '-l', '1024', '--taps', '8', '--method', 'separate'],
+            ['-c', '16', '-b', '500', '-l', '4096', '--taps', '16'],
+            ['-c', '16', '-b', '500', '-l', '4096', '--taps', '16', '--method', 'separate'],
+        ],
+    },
+    'pruned': {
+        'metric': 'gflops',
+        'cases': [
+            # 1K samples zero-padded to 16K, and a 64-bin band out of 16K
+            ['-b', '1000', '-l', '16384', '--input', '1024'],
+            ['-b', '1000', '-l', '16384', '--input', '1024', '--method', 'full'],
+            ['-b', '1000', '-l', '16384', '--bins', '64', '--first-bin', '1000'],
+            ['-b', '1000', '-l', '16384', '--bins', '64', '--first-bin', '1000', '--method', 'full'],
+            ['-b', '1000', '-l', '16384', '--input', '1024', '--bins', '256'],
+            ['-b', '200', '-l', '65536', '--input', '4096'],
+        ],
+    },
+    'sparse': {
+        'metric': 'signals_per_sec',
+        'cases': [
+            # Goertzel vs. FFT at 8 and 48 bins over the standard size table;
+            # the crossover table in src/sparse.cpp comes from these runs
+            ['-b', str(batch), '-l', str(length), '--bins', str(bins), '--method', method]
+            for batch, length in [(1000, 1024), (1000, 2048), (1000, 4096), (500, 8192),
+                                  (500, 16384), (250, 32768), (250, 65536), (250, 131072),
+                                  (250, 262144), (250, 524288)]
+            for bins in (8, 48)
+            for method in ('goertzel', 'fft')
+        ],
+    },
+    'czt': {
+        'metric': 'signals_per_sec',
+        'cases': [
+            # Zoom factors of ~60 to ~2500 over the 1/length resolution
+            ['-b', '1000', '-l', '4096', '--bins', '1000', '--band-start', '0.2', '--band-end', '0.201'],
+            ['-b', '1000', '-l', '1024', '--bins', '256', '--band-start', '0.1', '--band-end', '0.104'],
+            ['-b', '100', '-l', '16384', '--bins', '4096', '--band-start', '0.3', '--band-end', '0.3001'],
+        ],
+    },
+    'dct': {
+        'metric': 'transforms_per_sec',
+        'cases': [
+            # 8x8-block and audio-frame lengths; the r2r/fft baseline time is in each row
+            ['-b', '100000', '-l', '8'],
+            ['-b', '100000', '-l', '8', '--quant', '16'],
+            ['-b', '10000', '-l', '1024'],
+            ['-b', '10000', '-l', '1024', '--method', 'r2r'],
+            ['-b', '10000', '-l', '1024', '--quant', '4'],
+            ['-b', '10000', '-l', '1024', '--kind', 'dct3'],
+            ['-b', '2000', '-l', '4096', '--kind', 'dst2'],
+        ],
+    },
+    'hilbert': {
+        'metric': 'samples_per_sec',
+        'cases': [
+            # Analytic signal and envelope; the other method's time is in each row
+            ['-b', '4000', '-l', '1024'],
+            ['-b', '4000', '-l', '1024', '--envelope'],
+            ['-b', '4000', '-l', '1024', '--envelope', '--method', 'separate'],
+            ['-b', '1000', '-l', '4096', '--envelope'],
+            ['-b', '64', '-l', '65536', '--envelope'],
+        ],
+    },
+    'resample': {
+        'metric': 'output_samples_per_sec',
+        'cases': [
+            # 48 kHz <-> 32/72 kHz and integer factors, with fractional delays
+            ['-b', '100', '-l', '48000', '--ratio', '2/3', '--delay', '0.5'],
+            ['-b', '100', '-l', '48000', '--ratio', '3/2', '--delay', '0.5'],
+            ['-b', '100', '-l', '48000', '--ratio', '3/2', '--delay', '0.5', '--method', 'separate'],
+            ['-b', '4000', '-l', '1024', '--ratio', '1/4'],
+            ['-b', '4000', '-l', '1024', '--ratio', '4', '--delay', '2.5'],
+        ],
+    },
+    'csd': {
+        'metric': 'frames_per_sec',
+        'cases': [
+            # Array-sized channel counts, 50%-overlap Hann frames
+            ['-c', '8', '-b', '1000', '-l', '1024', '--hop', '512', '--window', 'hann'],
+            ['-c', '16', '-b', '500', '-l', '1024', '--hop', '512', '--window', 'hann'],
+            ['-c', '16', '-b', '500', '-l', '1024', '--hop', '512', '--window', 'hann', '--method', 'pairs'],
+            ['-c', '64', '-b', '200', '-l', '1024', '--hop', '512', '--window', 'hann'],
+            ['-c', '32', '-b', '100', '-l', '4096', '--hop', '2048', '--window', 'hann'],
+        ],
+    },
+}
+
+thread_counts = [1, 2, 4, 8]
+NUM_RUNS = 5
+
+def run_benchmark(mode, case, threads, metric):
+    """Run benchmark NUM_RUNS times and return the run with the median metric"""
+    try:
+        rows = []
+
+        for _ in range(NUM_RUNS):
+            result = subprocess.run(
+                ['./build/batch_fft', '-m', mode, '-t', str(threads)] + case,
+                capture_output=True,
+                text=True,
+                timeout=60
+            )
+
+            if result.returncode != 0:
+                print(f"Error running benchmark: {result.stderr}", file=sys.stderr)
+                continue
+
+            # Parse CSV output (header names differ between modes)
+            lines = result.stdout.strip().split('\n')
+            if len(lines) < 2:
+                continue
+
+            rows.append(next(csv.DictReader(lines)))
+
+        if not rows:
+            return None
+
+        rows.sort(key=lambda r: float(r[metric]))
+        return rows[len(rows) // 2]
+    except subprocess.TimeoutExpired:
+        print(f"Timeout for mode={mode}, case={' '.join(case)}, threads={threads}", file=sys.stderr)
+        return None
+    except Exception as e:
+        print(f"Exception: {e}", file=sys.stderr)
+        return None
+
+def find_best_thread_count(mode, case, metric):
+    """Find the optimal thread count for a given test case"""
+    best_result = None
+    best_value = 0
+
+    print(f"Testing {mode} {' '.join(case)}...", file=sys.stderr)
+
+    for threads in thread_counts:
+        result = run_benchmark(mode, case, threads, metric)
+        if result is None:
+            continue
+
+        value = float(result[metric])
+        print(f"  {threads} threads: {value:.0f} {metric} ({float(result['time_ms']):.2f} ms)", file=sys.stderr)
+
+        if value > best_value:
+            best_value = value
+            best_result = result
+
+    if best_result:
+        print(f"  → Best: {best_result['threads']} threads @ {best_value:.0f} {metric}\n", file=sys.stderr)
+
+    return best_result
+
+def main():
+    modes = sys.argv[1:] or list(MODES)
+
+    for mode in modes:
+        if mode not in MODES:
+            print(f"Unknown mode: {mode}", file=sys.stderr)
+            sys.exit(1)
+
+        print(f"FFTW {mode} Benchmark (Single Precision) - Finding optimal configurations", file=sys.stderr)
+        print("=" * 60, file=sys.stderr)
+
+        metric = MODES[mode]['metric']
+        results = []
+
+        for case in MODES[mode]['cases']:
+            result = find_best_thread_count(mode, case, metric)
+            if result:
+                results.append(result)
+
+        if not results:
+            continue
+
+        # Write results to CSV
+        output_file = f'{mode}_results_f32.csv'
+        with open(output_file, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=list(results[0].keys()))
+            writer.writeheader()
+            writer.writerows(results)
+
+        print(f"Results written to {output_file}\n", file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
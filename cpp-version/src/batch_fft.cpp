@@ -1,77 +1,644 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <vector>
 #include <complex>
 #include <chrono>
 #include <cmath>
 #include <cstring>
 #include <fftw3.h>
+#include "common.h"
+#include "dispatch.h"
+#include "kernels.h"
+#include "stft.h"
+#include "welch.h"
+#include "conv.h"
+#include "xcorr.h"
+#include "radar.h"
+#include "pfb.h"
+#include "pruned.h"
+#include "sparse.h"
+#include "czt.h"
+#include "sizes.h"
+#include "nd.h"
+#include "dct.h"
+#include "hilbert.h"
+#include "resample.h"
+#include "csd.h"
+#include "fixed_fft.h"
+#include "vertical.h"
+#include "four_step.h"
+#include "streaming.h"
+#include "layout.h"
+#include "bfp.h"
+#include "parallel.h"
 
 // Use single precision FFTW (fftwf_* functions)
 
-struct Args {
-    size_t batch;
-    size_t length;
-    int threads;
-};
-
 void print_usage(const char* program_name) {
-    std::cerr << "Usage: " << program_name << " -b <batch> -l <length> -t <threads>\n";
-    std::cerr << "  -b, --batch    Number of FFTs in the batch\n";
-    std::cerr << "  -l, --length   FFT transform length\n";
-    std::cerr << "  -t, --threads  Number of threads to use\n";
+    std::cerr << "Usage: " << program_name << " -b <batch> -l <length> -t <threads> [options]\n";
+    std::cerr << "  -b, --batch    Number of FFTs in the batch (frames per channel in framed modes, pulses in radar, spectra per stream in pfb)\n";
+    std::cerr << "  -l, --length   FFT transform length (samples per signal in conv, xcorr; range samples in radar; channels in pfb)\n";
+    std::cerr << "  -d, --dims     batch: dimensions of each transform, e.g. 512x512 or 128x128x128 (replaces -l)\n";
+    std::cerr << "  -t, --threads  Number of threads to use, or auto for every available core (batch: split\n";
+    std::cerr << "                 between signals and transforms by --parallel auto)\n";
+    std::cerr << "  -m, --mode     Processing mode: batch (default), stft, welch, conv, xcorr, radar, pfb, pruned, sparse, czt, sizes,\n";
+    std::cerr << "                 dct, hilbert, resample, csd\n";
+    std::cerr << "  -c, --channels Number of input signals in framed modes, CPIs in radar, streams in pfb (default 1)\n";
+    std::cerr << "      --hop      Frame advance in samples (default: length)\n";
+    std::cerr << "      --window   none, hann, hamming or blackman (default none)\n";
+    std::cerr << "      --taps     FIR filter length for conv, chirp length for radar, taps per branch for pfb (default 8)\n";
+    std::cerr << "      --method   conv: save (overlap-save, default) or add; radar: turn (default) or strided;\n";
+    std::cerr << "                 pfb: fused (default) or separate; pruned: auto (default), full, input or output;\n";
+    std::cerr << "                 sparse: auto (default), goertzel or fft; batch: auto (default), fftw, bluestein, fixed,\n";
+    std::cerr << "                 vertical, fourstep, fourstep_table or int16 (SC16 block floating point);\n";
+    std::cerr << "                 batch with -d: blocked (default), fftw or axes; dct: fft (default) or r2r;\n";
+    std::cerr << "                 hilbert, resample: fused (default) or separate; csd: blocked (default) or pairs\n";
+    std::cerr << "      --output   batch: inplace (default), cached (out of place) or stream (out of place,\n";
+    std::cerr << "                 non-temporal stores from a staging tile)\n";
+    std::cerr << "      --layout   batch input: contiguous (default) or interleaved (sample i of signal s at\n";
+    std::cerr << "                 i*batch + s, transformed into a contiguous array; --method auto (default),\n";
+    std::cerr << "                 gather or fftw)\n";
+    std::cerr << "      --parallel batch with --method fftw: fftw (default, FFTW's own threads), batch (one\n";
+    std::cerr << "                 contiguous chunk of signals per thread, single-threaded plans) or auto\n";
+    std::cerr << "                 (workers x threads per transform from a probed cost model; default with -t auto)\n";
+    std::cerr << "      --fft-size conv block transform size (default: automatic)\n";
+    std::cerr << "      --reference xcorr: correlate every signal against one reference\n";
+    std::cerr << "      --peaks    xcorr: output only the peak lag and value per pair\n";
+    std::cerr << "      --input    pruned: nonzero samples per signal, rest zero-padded (default: length)\n";
+    std::cerr << "      --bins     pruned: number of output bins kept (default: all); sparse: bins evaluated (default 10);\n";
+    std::cerr << "                 czt: bins across the band (default 1000)\n";
+    std::cerr << "      --first-bin pruned, sparse: first output bin (default 0)\n";
+    std::cerr << "      --band-start, --band-end czt: band edges in cycles/sample (default 0.2, 0.201)\n";
+    std::cerr << "      --kind     dct: dct2 (default), dct3, dst2 or dst3\n";
+    std::cerr << "      --quant    dct: quantize the output to int16 with this base step (default: off)\n";
+    std::cerr << "      --envelope hilbert: output only the envelope magnitude\n";
+    std::cerr << "      --ratio    resample: output/input rate p/q (default 1)\n";
+    std::cerr << "      --delay    resample: largest per-signal fractional delay in input samples (default 0)\n";
 }
 
 bool parse_args(int argc, char* argv[], Args& args) {
+    args.mode = "batch";
     args.batch = 0;
     args.length = 0;
     args.threads = 0;
+    args.channels = 1;
+    args.hop = 0;
+    args.window = "none";
+    args.taps = 0;
+    args.method = "";
+    args.output = "inplace";
+    args.layout = "contiguous";
+    args.parallel = "";
+    bool auto_threads = false;
+    args.fft_size = 0;
+    args.reference = false;
+    args.peaks = false;
+    args.input_length = 0;
+    args.bins = 0;
+    args.first_bin = 0;
+    args.band_start = 0.2;
+    args.band_end = 0.201;
+    args.kind = "";
+    args.quant_step = 0.0;
+    args.envelope = false;
+    args.up = 1;
+    args.down = 1;
+    args.delay = 0.0;
 
     for (int i = 1; i < argc; i++) {
         if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--batch") == 0) && i + 1 < argc) {
             args.batch = std::stoull(argv[++i]);
         } else if ((strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--length") == 0) && i + 1 < argc) {
             args.length = std::stoull(argv[++i]);
+        } else if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--dims") == 0) && i + 1 < argc) {
+            if (!parse_dims(argv[++i], args.dims)) {
+                return false;
+            }
         } else if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
-            args.threads = std::stoi(argv[++i]);
+            i++;
+            auto_threads = strcmp(argv[i], "auto") == 0;
+            args.threads = auto_threads ? available_cores() : std::stoi(argv[i]);
+        } else if ((strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--mode") == 0) && i + 1 < argc) {
+            args.mode = argv[++i];
+        } else if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--channels") == 0) && i + 1 < argc) {
+            args.channels = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--hop") == 0 && i + 1 < argc) {
+            args.hop = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            args.window = argv[++i];
+        } else if (strcmp(argv[i], "--taps") == 0 && i + 1 < argc) {
+            args.taps = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--method") == 0 && i + 1 < argc) {
+            args.method = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            args.output = argv[++i];
+        } else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            args.layout = argv[++i];
+        } else if (strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+            args.parallel = argv[++i];
+        } else if (strcmp(argv[i], "--fft-size") == 0 && i + 1 < argc) {
+            args.fft_size = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--reference") == 0) {
+            args.reference = true;
+        } else if (strcmp(argv[i], "--peaks") == 0) {
+            args.peaks = true;
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            args.input_length = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--bins") == 0 && i + 1 < argc) {
+            args.bins = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--first-bin") == 0 && i + 1 < argc) {
+            args.first_bin = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--band-start") == 0 && i + 1 < argc) {
+            args.band_start = std::stod(argv[++i]);
+        } else if (strcmp(argv[i], "--band-end") == 0 && i + 1 < argc) {
+            args.band_end = std::stod(argv[++i]);
+        } else if (strcmp(argv[i], "--kind") == 0 && i + 1 < argc) {
+            args.kind = argv[++i];
+        } else if (strcmp(argv[i], "--quant") == 0 && i + 1 < argc) {
+            args.quant_step = std::stod(argv[++i]);
+        } else if (strcmp(argv[i], "--envelope") == 0) {
+            args.envelope = true;
+        } else if (strcmp(argv[i], "--ratio") == 0 && i + 1 < argc) {
+            if (!parse_ratio(argv[++i], args.up, args.down)) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            args.delay = std::stod(argv[++i]);
         } else {
             return false;
         }
     }
 
-    return args.batch > 0 && args.length > 0 && args.threads > 0;
+    if (!args.dims.empty()) {
+        args.length = 1;
+        for (size_t a = 0; a < args.dims.size(); a++) {
+            args.length *= args.dims[a];
+        }
+    }
+    if (args.hop == 0) {
+        args.hop = args.length;
+    }
+    if (args.parallel.empty()) {
+        args.parallel = auto_threads ? "auto" : "fftw";
+    }
+
+    return args.batch > 0 && args.length > 0 && args.threads > 0 && args.channels > 0;
 }
 
+static void print_batch_result(const Args& args, const std::string& method,
+                               std::chrono::duration<double> duration) {
+    // Calculate performance metrics
+    double time_ms = duration.count() * 1000.0;
+    double flops = calculate_flops(args.batch, args.length);
+    double gflops = flops / duration.count() / 1e9;
+    double transforms_per_sec = static_cast<double>(args.batch) / duration.count();
 
-double calculate_flops(size_t batch, size_t length) {
-    double n = static_cast<double>(length);
-    double b = static_cast<double>(batch);
-    return b * 5.0 * n * std::log2(n);
+    // Output results as CSV
+    std::cout << "batch,fft_length,threads,time_ms,gflops,method,transforms_per_sec\n";
+    std::cout << args.batch << "," << args.length << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << gflops << ","
+              << method << ","
+              << std::fixed << std::setprecision(0) << transforms_per_sec << "\n";
 }
 
-int main(int argc, char* argv[]) {
-    Args args;
+// Time the vertical kernel against fftwf_plan_many_dft on the same slice
+// of the batch (about 256K samples) and report whether it was faster
+static bool prefer_vertical(const Args& args) {
+    size_t probe = std::min(args.batch, std::max<size_t>((size_t(1) << 18) / args.length,
+                                                         VERTICAL_LANES * args.threads));
+    fftwf_complex* buffer = fftwf_alloc_complex(probe * args.length);
+    int n[] = {static_cast<int>(args.length)};
+    fftwf_plan plan = fftwf_plan_many_dft(1, n, static_cast<int>(probe), buffer, NULL, 1,
+                                          static_cast<int>(args.length), buffer, NULL, 1,
+                                          static_cast<int>(args.length), FFTW_FORWARD, FFTW_MEASURE);
+    if (plan == NULL) {
+        fftwf_free(buffer);
+        return false;
+    }
+    for (size_t i = 0; i < probe * args.length; i++) {
+        buffer[i][0] = static_cast<float>(i % 7) - 3.0f;
+        buffer[i][1] = 0.0f;
+    }
+    VerticalBatch vb;
+    create_vertical_batch(vb, probe, args.length, args.threads);
 
-    if (!parse_args(argc, argv, args)) {
-        print_usage(argv[0]);
-        return 1;
+    // The first pass of each warms the caches
+    double times[2];
+    for (int i = 0; i < 2; i++) {
+        for (int pass = 0; pass < 2; pass++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (i == 0) {
+                execute_vertical_batch(vb, buffer, probe);
+            } else {
+                fftwf_execute(plan);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            times[i] = std::chrono::duration<double>(end - start).count();
+        }
     }
+    fftwf_destroy_plan(plan);
+    fftwf_free(buffer);
+    return times[0] < times[1];
+}
 
-    // Initialize FFTW threading (single precision version)
-    fftwf_init_threads();
+// Time the gather against FFTW's strided plan on the first signals of the
+// interleaved arrays (about 1M samples, every row of them) and report
+// whether it was faster. Which one wins depends on the length, the batch
+// and the memory system: the gather does when the input streams from
+// memory at 1024-4096 points, FFTW's plan, which vectorizes across
+// neighbouring signals, when the input stays in cache. Planning overwrites
+// both arrays.
+static bool prefer_gather(const Args& args, fftwf_complex* in, fftwf_complex* out) {
+    size_t probe = std::min(args.batch, std::max<size_t>(64, (size_t(1) << 20) / args.length));
+    GatherBatch gb;
+    bool planned = create_gather_batch(gb, probe, args.length, args.batch, 1);
+    int n[] = {static_cast<int>(args.length)};
+    fftwf_plan_with_nthreads(1);
+    fftwf_plan plan = fftwf_plan_many_dft(1, n, static_cast<int>(probe), in, NULL,
+                                          static_cast<int>(args.batch), 1, out, NULL, 1,
+                                          static_cast<int>(args.length), FFTW_FORWARD, FFTW_MEASURE);
     fftwf_plan_with_nthreads(args.threads);
+    if (!planned || plan == NULL) {
+        destroy_gather_batch(gb);
+        if (plan != NULL) {
+            fftwf_destroy_plan(plan);
+        }
+        return planned;
+    }
+
+    // The first pass of each warms the caches
+    double times[2];
+    for (int i = 0; i < 2; i++) {
+        for (int pass = 0; pass < 2; pass++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (i == 0) {
+                execute_gather_batch(gb, in, out);
+            } else {
+                fftwf_execute(plan);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            times[i] = std::chrono::duration<double>(end - start).count();
+        }
+    }
+    fftwf_destroy_plan(plan);
+    destroy_gather_batch(gb);
+    return times[0] < times[1];
+}
+
+// Sample-major input into a contiguous output array: FFTW reading the
+// interleaved samples through a strided plan, or tiles gathered into the
+// output by the prefetching transpose and transformed there (layout.h)
+static int run_interleaved_batch(const Args& args, fftwf_complex* data) {
+    std::string method = args.method.empty() ? "auto" : args.method;
+    if (method != "auto" && method != "gather" && method != "fftw") {
+        std::cerr << "Error: batch --layout interleaved --method must be auto, gather or fftw\n";
+        return 1;
+    }
+    if (args.output != "inplace") {
+        std::cerr << "Error: batch --layout interleaved always writes a separate contiguous array, "
+                     "leave --output at inplace\n";
+        return 1;
+    }
+
+    // Both arrays are touched beforehand so page faults stay out of the
+    // timing; the probe and the plans may overwrite them until the input
+    // is filled with the interleaved tones
+    size_t total_size = args.batch * args.length;
+    fftwf_complex* in = fftwf_alloc_complex(total_size);
+    fftwf_complex* out = fftwf_alloc_complex(total_size);
+    memset(in, 0, total_size * sizeof(fftwf_complex));
+    memset(out, 0, total_size * sizeof(fftwf_complex));
+    if (method == "auto") {
+        method = prefer_gather(args, in, out) ? "gather" : "fftw";
+    }
+
+    // FFTW's strided plan is built either way: it is the fftw method and
+    // the baseline of the gather's speedup column
+    GatherBatch gb;
+    bool gathered = method == "gather";
+    bool planned = !gathered || create_gather_batch(gb, args.batch, args.length, args.batch, args.threads);
+    int n[] = {static_cast<int>(args.length)};
+    fftwf_plan strided = fftwf_plan_many_dft(1, n, static_cast<int>(args.batch), in, NULL,
+                                             static_cast<int>(args.batch), 1, out, NULL, 1,
+                                             static_cast<int>(args.length), FFTW_FORWARD, FFTW_MEASURE);
+    if (!planned || strided == NULL) {
+        std::cerr << "Error: FFTW could not create the " << method << " plans\n";
+        if (gathered) {
+            destroy_gather_batch(gb);
+        }
+        if (strided != NULL) {
+            fftwf_destroy_plan(strided);
+        }
+        fftwf_free(out);
+        fftwf_free(in);
+        return 1;
+    }
+    transpose(data, args.batch, args.length, args.length, in, args.batch, 0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (gathered) {
+        execute_gather_batch(gb, in, out);
+    } else {
+        fftwf_execute(strided);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    // The gather leaves the input intact, so the strided plan runs on the
+    // same data afterwards
+    std::chrono::duration<double> strided_duration = duration;
+    if (gathered) {
+        auto strided_start = std::chrono::high_resolution_clock::now();
+        fftwf_execute(strided);
+        auto strided_end = std::chrono::high_resolution_clock::now();
+        strided_duration = strided_end - strided_start;
+        destroy_gather_batch(gb);
+    }
+    fftwf_destroy_plan(strided);
+
+    double time_ms = duration.count() * 1000.0;
+    double strided_time_ms = strided_duration.count() * 1000.0;
+    double gflops = calculate_flops(args.batch, args.length) / duration.count() / 1e9;
+    double transforms_per_sec = static_cast<double>(args.batch) / duration.count();
+    std::cout << "batch,fft_length,threads,time_ms,gflops,method,transforms_per_sec,"
+                 "fftw_strided_time_ms,speedup\n";
+    std::cout << args.batch << "," << args.length << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << gflops << ","
+              << (gathered ? "gather" : "fftw_interleaved") << ","
+              << std::fixed << std::setprecision(0) << transforms_per_sec << ","
+              << std::fixed << std::setprecision(3) << strided_time_ms << ","
+              << std::fixed << std::setprecision(2) << strided_time_ms / time_ms << "\n";
+    fftwf_free(out);
+    fftwf_free(in);
+    return 0;
+}
+
+// SC16 in and out through the block-floating-point int16 FFT (bfp.h). The
+// tones are quantized at -6 dBFS. Afterwards the spectra, scaled by their
+// exponents, are compared with FFTW in single precision on the same
+// quantized samples, and the SQNR goes in an extra column.
+static int run_int16_batch(const Args& args, fftwf_complex* data) {
+    Int16Batch ib;
+    if (!create_int16_batch(ib, args.batch, args.length, args.threads)) {
+        std::cerr << "Error: --method int16 needs a power-of-two length\n";
+        return 1;
+    }
+    size_t total = 2 * args.batch * args.length;
+    float* samples = reinterpret_cast<float*>(data);
+    std::vector<int16_t> in(total);
+    std::vector<int16_t> out(total);
+    std::vector<int> exponents(args.batch);
+    for (size_t i = 0; i < total; i++) {
+        in[i] = static_cast<int16_t>(std::lround(samples[i] * 16384.0f));
+    }
 
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_int16_batch(ib, in.data(), out.data(), exponents.data());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Reference in place on `data`, which is not needed any more
+    for (size_t i = 0; i < total; i++) {
+        samples[i] = static_cast<float>(in[i]);
+    }
+    int n[] = {static_cast<int>(args.length)};
+    fftwf_plan plan = fftwf_plan_many_dft(1, n, static_cast<int>(args.batch), data, NULL, 1,
+                                          static_cast<int>(args.length), data, NULL, 1,
+                                          static_cast<int>(args.length), FFTW_FORWARD, FFTW_ESTIMATE);
+    fftwf_execute(plan);
+    fftwf_destroy_plan(plan);
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t s = 0; s < args.batch; s++) {
+        double scale = std::ldexp(1.0, exponents[s]);
+        for (size_t i = 2 * s * args.length; i < 2 * (s + 1) * args.length; i++) {
+            double error = static_cast<double>(out[i]) * scale - samples[i];
+            signal += static_cast<double>(samples[i]) * samples[i];
+            noise += error * error;
+        }
+    }
+    double sqnr = 10.0 * std::log10(signal / noise);
+
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double gflops = calculate_flops(args.batch, args.length) / duration.count() / 1e9;
+    double transforms_per_sec = static_cast<double>(args.batch) / duration.count();
+    std::cout << "batch,fft_length,threads,time_ms,gflops,method,transforms_per_sec,sqnr_db\n";
+    std::cout << args.batch << "," << args.length << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << gflops << ",int16,"
+              << std::fixed << std::setprecision(0) << transforms_per_sec << ","
+              << std::fixed << std::setprecision(1) << sqnr << "\n";
+    return 0;
+}
+
+// Plain batched transform: `batch` contiguous signals of `length` samples
+int run_batch(const Args& args) {
     // Initialize input data: batch of signals in a contiguous array
     size_t total_size = args.batch * args.length;
     fftwf_complex* data = fftwf_alloc_complex(total_size);
 
-    // Generate sample data (sine wave with varying frequencies)
-    for (size_t i = 0; i < total_size; i++) {
-        float t = static_cast<float>(i % args.length) / static_cast<float>(args.length);
-        size_t batch_idx = i / args.length;
-        float freq = 1.0f + static_cast<float>(batch_idx);
-        data[i][0] = std::cos(2.0f * M_PI * freq * t);  // Real part
-        data[i][1] = 0.0f;  // Imaginary part
+    // Generate sample data (cosine waves with varying frequencies)
+    generate_tones(data, args.batch, args.length);
+
+    if (args.layout != "contiguous" && args.layout != "interleaved") {
+        std::cerr << "Error: batch --layout must be contiguous or interleaved\n";
+        fftwf_free(data);
+        return 1;
+    }
+    if (args.layout == "interleaved") {
+        int status = run_interleaved_batch(args, data);
+        fftwf_free(data);
+        return status;
+    }
+
+    // Lengths with a compile-time kernel use it; large prime factors go
+    // through Bluestein's chirp-Z convolution (--method auto decides by the
+    // largest prime factor)
+    std::string method = args.method.empty() ? "auto" : args.method;
+    if (args.output != "inplace" && args.output != "cached" && args.output != "stream") {
+        std::cerr << "Error: batch --output must be inplace, cached or stream\n";
+        fftwf_free(data);
+        return 1;
+    }
+    bool out_of_place = args.output != "inplace";
+    if (out_of_place && method == "auto") {
+        method = "fftw";
+    }
+    if (out_of_place && method != "fftw") {
+        std::cerr << "Error: --output " << args.output << " runs through FFTW (--method fftw)\n";
+        fftwf_free(data);
+        return 1;
+    }
+    if (args.parallel != "fftw" && args.parallel != "batch" && args.parallel != "auto") {
+        std::cerr << "Error: batch --parallel must be fftw, batch or auto\n";
+        fftwf_free(data);
+        return 1;
+    }
+    // auto only changes the plain FFTW path; the other kernels already
+    // split the batch over their threads
+    bool chunked = args.parallel != "fftw";
+    if (args.parallel == "batch" && method == "auto") {
+        method = "fftw";
+    }
+    if (args.parallel == "batch" && (method != "fftw" || out_of_place)) {
+        std::cerr << "Error: --parallel batch runs in place through FFTW (--method fftw)\n";
+        fftwf_free(data);
+        return 1;
+    }
+    if (method == "auto") {
+        if (find_fixed_fft(args.length) != NULL) {
+            method = "fixed";
+        } else if (vertical_supported(args.length)) {
+            method = prefer_vertical(args) ? "vertical" : "fftw";
+        } else {
+            method = prefer_bluestein(args.length) ? "bluestein" : "fftw";
+        }
+    }
+    if (method != "fftw" && method != "bluestein" && method != "fixed" && method != "vertical" &&
+        method != "fourstep" && method != "fourstep_table" && method != "int16") {
+        std::cerr << "Error: batch --method must be auto, fftw, bluestein, fixed, vertical, fourstep, "
+                     "fourstep_table or int16\n";
+        fftwf_free(data);
+        return 1;
+    }
+    if (method == "int16") {
+        int status = run_int16_batch(args, data);
+        fftwf_free(data);
+        return status;
+    }
+
+    // Out of place into a separate array, touched beforehand so page faults
+    // stay out of the timing: one FFTW plan writing through the caches, or
+    // staging tiles streamed out with non-temporal stores
+    if (out_of_place) {
+        fftwf_complex* out = fftwf_alloc_complex(total_size);
+        memset(out, 0, total_size * sizeof(fftwf_complex));
+        std::chrono::high_resolution_clock::time_point start;
+        std::chrono::high_resolution_clock::time_point end;
+        if (args.output == "stream") {
+            StreamingBatch sb;
+            if (!create_streaming_batch(sb, args.batch, args.length, args.threads)) {
+                std::cerr << "Error: FFTW could not create the staging tile plans\n";
+                destroy_streaming_batch(sb);
+                fftwf_free(out);
+                fftwf_free(data);
+                return 1;
+            }
+            start = std::chrono::high_resolution_clock::now();
+            execute_streaming_batch(sb, data, out);
+            end = std::chrono::high_resolution_clock::now();
+            destroy_streaming_batch(sb);
+        } else {
+            int n[] = {static_cast<int>(args.length)};
+            fftwf_plan plan = fftwf_plan_many_dft(1, n, static_cast<int>(args.batch), data, NULL, 1,
+                                                  static_cast<int>(args.length), out, NULL, 1,
+                                                  static_cast<int>(args.length), FFTW_FORWARD, FFTW_MEASURE);
+            start = std::chrono::high_resolution_clock::now();
+            fftwf_execute(plan);
+            end = std::chrono::high_resolution_clock::now();
+            fftwf_destroy_plan(plan);
+        }
+        print_batch_result(args, method + "_" + args.output, end - start);
+        fftwf_free(out);
+        fftwf_free(data);
+        return 0;
+    }
+
+    if (method == "vertical") {
+        VerticalBatch vb;
+        if (!create_vertical_batch(vb, args.batch, args.length, args.threads)) {
+            std::cerr << "Error: --method vertical needs the avx2 or avx512 kernels and a power-of-two length from "
+                      << MIN_VERTICAL_LENGTH << " to " << MAX_VERTICAL_LENGTH << "\n";
+            fftwf_free(data);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_vertical_batch(vb, data, args.batch);
+        auto end = std::chrono::high_resolution_clock::now();
+        print_batch_result(args, method, end - start);
+        fftwf_free(data);
+        return 0;
+    }
+
+    if (method == "fixed") {
+        FixedBatch fb;
+        if (!create_fixed_batch(fb, args.batch, args.length, args.threads)) {
+            std::cerr << "Error: no fixed-length kernel for length " << args.length << " (built for";
+            std::vector<size_t> lengths = fixed_fft_lengths();
+            for (size_t i = 0; i < lengths.size(); i++) {
+                std::cerr << " " << lengths[i];
+            }
+            std::cerr << ")\n";
+            destroy_fixed_batch(fb);
+            fftwf_free(data);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_fixed_batch(fb, data);
+        auto end = std::chrono::high_resolution_clock::now();
+        print_batch_result(args, method, end - start);
+        destroy_fixed_batch(fb);
+        fftwf_free(data);
+        return 0;
+    }
+
+    if (method == "fourstep" || method == "fourstep_table") {
+        FourStepBatch fs;
+        if (!create_four_step(fs, args.batch, args.length, args.threads, method == "fourstep_table")) {
+            std::cerr << "Error: --method " << method << " needs a length N1 × N2 with both factors multiples of "
+                      << FOUR_STEP_BLOCK << "\n";
+            destroy_four_step(fs);
+            fftwf_free(data);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_four_step(fs, data);
+        auto end = std::chrono::high_resolution_clock::now();
+        print_batch_result(args, method, end - start);
+        destroy_four_step(fs);
+        fftwf_free(data);
+        return 0;
+    }
+
+    if (method == "bluestein") {
+        ChirpZ cz;
+        if (!create_bluestein(cz, args.batch, args.length, args.threads)) {
+            std::cerr << "Error: FFTW could not create the Bluestein plans\n";
+            destroy_chirp_z(cz);
+            fftwf_free(data);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_chirp_z(cz, data, data);
+        auto end = std::chrono::high_resolution_clock::now();
+        print_batch_result(args, method, end - start);
+        destroy_chirp_z(cz);
+        fftwf_free(data);
+        return 0;
+    }
+
+    // One contiguous chunk of signals per worker, each through its own
+    // plan: single-threaded, or with auto as many threads per transform as
+    // the cost model picks
+    if (chunked) {
+        int inner = args.parallel == "auto" ? choose_inner_threads(args.batch, args.length, args.threads) : 1;
+        ChunkedBatch cb;
+        if (!create_chunked_batch(cb, data, args.batch, args.length, args.threads, inner)) {
+            std::cerr << "Error: FFTW could not create the chunk plans\n";
+            destroy_chunked_batch(cb);
+            fftwf_free(data);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_chunked_batch(cb, data);
+        auto end = std::chrono::high_resolution_clock::now();
+        print_batch_result(args, "fftw_" + args.parallel, end - start);
+        destroy_chunked_batch(cb);
+        fftwf_free(data);
+        return 0;
     }
 
     // Create batch FFT plan before timing using FFTW's native batch interface
@@ -105,22 +672,70 @@ int main(int argc, char* argv[]) {
     fftwf_execute(plan);
     auto end = std::chrono::high_resolution_clock::now();
 
-    // Calculate performance metrics
-    std::chrono::duration<double> duration = end - start;
-    double time_ms = duration.count() * 1000.0;
-    double flops = calculate_flops(args.batch, args.length);
-    double gflops = flops / duration.count() / 1e9;
-
-    // Output results as CSV
-    std::cout << "batch,fft_length,threads,time_ms,gflops\n";
-    std::cout << args.batch << "," << args.length << "," << args.threads << ","
-              << std::fixed << std::setprecision(3) << time_ms << ","
-              << std::fixed << std::setprecision(0) << gflops << "\n";
+    print_batch_result(args, method, end - start);
 
     // Cleanup
     fftwf_destroy_plan(plan);
     fftwf_free(data);
-    fftwf_cleanup_threads();
 
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    Args args;
+
+    if (!parse_args(argc, argv, args)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Pick the kernel ISA level once, before anything is timed
+    const char* isa = kernels().isa;
+    std::cerr << "kernels: " << isa << "\n";
+    report_threading();
+
+    // Initialize FFTW threading (single precision version)
+    fftwf_init_threads();
+    fftwf_plan_with_nthreads(args.threads);
+
+    int status;
+    if (args.mode == "batch") {
+        status = args.dims.size() > 1 ? run_nd(args) : run_batch(args);
+    } else if (args.mode == "stft") {
+        status = run_stft(args);
+    } else if (args.mode == "welch") {
+        status = run_welch(args);
+    } else if (args.mode == "conv") {
+        status = run_conv(args);
+    } else if (args.mode == "xcorr") {
+        status = run_xcorr(args);
+    } else if (args.mode == "radar") {
+        status = run_radar(args);
+    } else if (args.mode == "pfb") {
+        status = run_pfb(args);
+    } else if (args.mode == "pruned") {
+        status = run_pruned(args);
+    } else if (args.mode == "sparse") {
+        status = run_sparse(args);
+    } else if (args.mode == "czt") {
+        status = run_czt(args);
+    } else if (args.mode == "sizes") {
+        status = run_sizes(args);
+    } else if (args.mode == "dct") {
+        status = run_dct(args);
+    } else if (args.mode == "hilbert") {
+        status = run_hilbert(args);
+    } else if (args.mode == "resample") {
+        status = run_resample(args);
+    } else if (args.mode == "csd") {
+        status = run_csd(args);
+    } else {
+        std::cerr << "Error: unknown mode '" << args.mode << "'\n";
+        print_usage(argv[0]);
+        status = 1;
+    }
+
+    fftwf_cleanup_threads();
+
+    return status;
+}
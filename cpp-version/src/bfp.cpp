@@ -0,0 +1,105 @@
+#include "bfp.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+// W_n^e as Q15 pairs at entry `at`
+static void set_twiddle(std::vector<int16_t>& w_re, std::vector<int16_t>& w_im, size_t at, size_t e,
+                        size_t n) {
+    double angle = -2.0 * M_PI * static_cast<double>(e) / static_cast<double>(n);
+    int16_t wr = static_cast<int16_t>(std::lround(32767.0 * std::cos(angle)));
+    int16_t wi = static_cast<int16_t>(std::lround(32767.0 * std::sin(angle)));
+    w_re[2 * at] = wr;
+    w_re[2 * at + 1] = wr;
+    w_im[2 * at] = static_cast<int16_t>(-wi);
+    w_im[2 * at + 1] = wi;
+}
+
+bool create_int16_batch(Int16Batch& ib, size_t batch, size_t length, int threads) {
+    if (length < 2 || (length & (length - 1)) != 0) {
+        return false;
+    }
+    ib.batch = batch;
+    ib.length = length;
+    ib.workers = std::min<size_t>(static_cast<size_t>(threads), batch);
+    ib.w_re.resize(length);
+    ib.w_im.resize(length);
+    for (size_t k = 0; k < length / 2; k++) {
+        set_twiddle(ib.w_re, ib.w_im, k, k, length);
+    }
+    const size_t q = length / 4;
+    ib.r4_re.resize(6 * q);
+    ib.r4_im.resize(6 * q);
+    for (size_t j = 1; j <= 3; j++) {
+        for (size_t k = 0; k < q; k++) {
+            set_twiddle(ib.r4_re, ib.r4_im, (j - 1) * q + k, j * k, length);
+        }
+    }
+    ib.work.resize(2 * length * ib.workers);
+    return true;
+}
+
+// Smallest shift that brings `peak` under `limit`
+static unsigned stage_shift(unsigned peak, unsigned limit) {
+    unsigned shift = 0;
+    while ((peak >> shift) >= limit) {
+        shift++;
+    }
+    return shift;
+}
+
+// One signal: radix-4 stages, then a radix-2 stage for odd log2 N. The
+// first reads the input and the stages alternate between `out` and `work`
+// so that the last one writes `out`.
+static int int16_signal(const Int16Batch& ib, const int16_t* in, int16_t* out, int16_t* work) {
+    const size_t n = ib.length;
+    size_t log2n = 0;
+    while ((size_t(1) << log2n) < n) {
+        log2n++;
+    }
+    size_t stages = log2n / 2 + log2n % 2;
+
+    const int16_t* x = in;
+    int16_t* y = stages % 2 == 1 ? out : work;
+    unsigned peak = max_abs_int16(in, 2 * n);
+    int exponent = 0;
+    size_t s = 1;
+    while (s < n) {
+        if ((n / s) % 4 != 0) {
+            unsigned shift = stage_shift(peak, BFP_LIMIT);
+            peak = bfp_radix2_stage(x, y, n, s, ib.w_re.data(), ib.w_im.data(), shift);
+            exponent += static_cast<int>(shift);
+            s *= 2;
+        } else {
+            unsigned shift = stage_shift(peak, BFP_LIMIT / 2);
+            peak = bfp_radix4_stage(x, y, n, s, ib.r4_re.data(), ib.r4_im.data(), shift);
+            exponent += static_cast<int>(shift);
+            s *= 4;
+        }
+        x = y;
+        y = y == out ? work : out;
+    }
+    return exponent;
+}
+
+static void int16_worker(Int16Batch& ib, const int16_t* in, int16_t* out, int* exponents, size_t id) {
+    int16_t* work = ib.work.data() + 2 * ib.length * id;
+    for (size_t s = id; s < ib.batch; s += ib.workers) {
+        size_t offset = 2 * s * ib.length;
+        exponents[s] = int16_signal(ib, in + offset, out + offset, work);
+    }
+}
+
+void execute_int16_batch(Int16Batch& ib, const int16_t* in, int16_t* out, int* exponents) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < ib.workers; id++) {
+        pool.push_back(std::thread(int16_worker, std::ref(ib), in, out, exponents, id));
+    }
+    int16_worker(ib, in, out, exponents, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
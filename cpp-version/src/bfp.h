@@ -0,0 +1,43 @@
+#ifndef BATCH_FFT_BFP_H
+#define BATCH_FFT_BFP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block-floating-point int16 FFT for SC16 data: signals of complex int16
+// samples (re, im interleaved) in, SC16 spectra and one exponent per
+// signal out, with X[k] ≈ y[k]·2^exponent in the units of the input. No
+// sample is converted to float.
+//
+// The transform is a radix-4 Stockham schedule, radix-2 last for odd
+// log2 N (bfp_radix4_stage and bfp_radix2_stage in kernels.h),
+// ping-ponging between the output and a per-worker work signal. Before each
+// stage the block maximum, tracked by the stage before, picks the smallest
+// shift that brings it under the stage's limit; the stage scales its inputs
+// by that shift with rounding and the shifts add up to the exponent. A
+// radix-2 stage grows a component by at most 2√2 and a radix-4 stage by
+// 4√2, so BFP_LIMIT = ⌊2^15 / 2√2⌋ and half of it keep every output in
+// range. The avx2 and avx512 kernel levels work on eight complex samples
+// per register, twice as many as the float kernels.
+const unsigned BFP_LIMIT = 11585;
+
+struct Int16Batch {
+    size_t batch;
+    size_t length;
+    size_t workers;             // signals id, id + workers, ... per worker
+    std::vector<int16_t> w_re;  // W_N^k, k < N/2, as Q15 pairs (wr, wr)
+    std::vector<int16_t> w_im;  // and (-wi, wi)
+    std::vector<int16_t> r4_re; // W_N^(j·k), j = 1..3, k < N/4, same pairs
+    std::vector<int16_t> r4_im;
+    std::vector<int16_t> work;  // one signal per worker
+};
+
+// False unless `length` is a power of two of at least 2
+bool create_int16_batch(Int16Batch& ib, size_t batch, size_t length, int threads);
+
+// Transform `batch` contiguous SC16 signals from `in` into `out`, one
+// exponent per signal
+void execute_int16_batch(Int16Batch& ib, const int16_t* in, int16_t* out, int* exponents);
+
+#endif // BATCH_FFT_BFP_H
@@ -0,0 +1,101 @@
+#include "common.h"
+
+#include <cmath>
+#include <unistd.h>
+
+double calculate_flops(size_t batch, size_t length) {
+    double n = static_cast<double>(length);
+    double b = static_cast<double>(batch);
+    return b * 5.0 * n * std::log2(n);
+}
+
+bool keeps_alignment(size_t offset) {
+    return (offset * 2 * sizeof(float)) % 16 == 0;
+}
+
+bool parse_dims(const std::string& spec, std::vector<size_t>& dims) {
+    dims.clear();
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = spec.find('x', begin);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string field = spec.substr(begin, end - begin);
+        if (field.empty() || field.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        size_t n = std::stoull(field);
+        if (n == 0) {
+            return false;
+        }
+        dims.push_back(n);
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool parse_ratio(const std::string& spec, size_t& up, size_t& down) {
+    size_t slash = spec.find('/');
+    std::string p = spec.substr(0, slash);
+    std::string q = slash == std::string::npos ? "1" : spec.substr(slash + 1);
+    if (p.empty() || q.empty() || p.find_first_not_of("0123456789") != std::string::npos ||
+        q.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    up = std::stoull(p);
+    down = std::stoull(q);
+    return up > 0 && down > 0;
+}
+
+size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+size_t cache_size(int level) {
+    long size = -1;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    switch (level) {
+        case 1: size = sysconf(_SC_LEVEL1_DCACHE_SIZE); break;
+        case 2: size = sysconf(_SC_LEVEL2_CACHE_SIZE); break;
+        case 3: size = sysconf(_SC_LEVEL3_CACHE_SIZE); break;
+    }
+#endif
+    if (size > 0) {
+        return static_cast<size_t>(size);
+    }
+
+    // Not reported (macOS, some containers): assume a small desktop part
+    switch (level) {
+        case 1: return 32 * 1024;
+        case 2: return 256 * 1024;
+        default: return 8 * 1024 * 1024;
+    }
+}
+
+bool parse_window(const std::string& name, CosineWindow& window) {
+    if (name == "none" || name == "rect") {
+        window.a0 = 1.0f; window.a1 = 0.0f; window.a2 = 0.0f;
+    } else if (name == "hann") {
+        window.a0 = 0.5f; window.a1 = 0.5f; window.a2 = 0.0f;
+    } else if (name == "hamming") {
+        window.a0 = 0.54f; window.a1 = 0.46f; window.a2 = 0.0f;
+    } else if (name == "blackman") {
+        window.a0 = 0.42f; window.a1 = 0.5f; window.a2 = 0.08f;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void fill_window(const CosineWindow& window, float* w, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        double phase = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(n);
+        w[i] = static_cast<float>(window.a0 - window.a1 * std::cos(phase) +
+                                  window.a2 * std::cos(2.0 * phase));
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef BATCH_FFT_COMMON_H
+#define BATCH_FFT_COMMON_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Command-line options shared by every processing mode
+struct Args {
+    std::string mode;       // processing mode ("batch" is the plain batched FFT)
+    size_t batch;           // number of transforms (frames per channel in framed modes)
+    size_t length;          // transform length (samples per signal in conv mode)
+    int threads;
+    size_t channels;        // independent input streams (framed modes), CPIs (radar)
+    size_t hop;             // frame advance in samples (framed modes)
+    std::string window;     // none, hann, hamming, blackman
+    size_t taps;            // FIR filter length (conv), chirp length (radar)
+    std::string method;     // algorithm variant, empty for the mode's default
+    std::string output;     // batch: inplace (default), cached or stream
+    std::string layout;     // batch input: contiguous (default) or interleaved (sample-major)
+    std::string parallel;   // batch threads: fftw (default, FFTW's own) or batch (one chunk per thread)
+    size_t fft_size;        // conv block transform size, 0 = automatic
+    bool reference;         // xcorr: correlate the batch against one reference
+    bool peaks;             // xcorr: return only the peak lag/value per pair
+    size_t input_length;    // nonzero leading samples per signal (pruned), 0 = length
+    size_t bins;            // output bins (pruned, sparse, czt), 0 = mode default
+    size_t first_bin;       // first output bin (pruned, sparse)
+    double band_start;      // czt band edges, normalized frequency (cycles/sample)
+    double band_end;
+    std::vector<size_t> dims;   // batch: dimensions of each transform (-d), empty = rank 1
+    std::string kind;       // dct: dct2, dct3, dst2 or dst3
+    double quant_step;      // dct: base quantization step of the output, 0 = off
+    bool envelope;          // hilbert: output only the envelope |z|
+    size_t up;              // resample: output/input length ratio up/down
+    size_t down;
+    double delay;           // resample: largest per-signal delay in input samples
+};
+
+// Standard FFT FLOP count: Batch × 5 × N × log2(N)
+double calculate_flops(size_t batch, size_t length);
+
+// True when a pointer advanced by `offset` complex samples keeps FFTW's
+// 16-byte SIMD alignment. fftwf_execute_dft may only be called on arrays
+// with the same alignment as the ones used for planning.
+bool keeps_alignment(size_t offset);
+
+// Parse a dimension spec such as "512x512" or "128x128x128". Returns false
+// for an empty, zero or malformed dimension.
+bool parse_dims(const std::string& spec, std::vector<size_t>& dims);
+
+// Parse a rate ratio "p/q" or "p" (q = 1). Returns false for a zero or
+// malformed term.
+bool parse_ratio(const std::string& spec, size_t& up, size_t& down);
+
+// Smallest power of two >= n
+size_t next_pow2(size_t n);
+
+// Size in bytes of the given data cache level (1, 2 or 3), with a
+// conservative fallback when the OS does not report it
+size_t cache_size(int level);
+
+// Periodic cosine-sum window w[n] = a0 - a1*cos(2πn/N) + a2*cos(4πn/N).
+// Returns false for an unknown window name.
+struct CosineWindow {
+    float a0;
+    float a1;
+    float a2;
+};
+
+bool parse_window(const std::string& name, CosineWindow& window);
+
+// Sample the window into w[0..n)
+void fill_window(const CosineWindow& window, float* w, size_t n);
+
+#endif // BATCH_FFT_COMMON_H
@@ -0,0 +1,349 @@
+#include "conv.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+struct ConvPlan {
+    bool overlap_add;
+    size_t batch;
+    size_t signal_length;
+    size_t taps;
+    size_t fft_size;        // N
+    size_t step;            // L = N - taps + 1 new output samples per block
+    size_t blocks;          // blocks per signal
+    size_t input_stride;    // distance between signals in the input array
+    size_t input_offset;    // first signal sample within its input slot
+    size_t tile;            // blocks transformed together
+    size_t workers;
+    fftwf_complex* filter;  // filter spectrum, scaled by 1/N
+    std::vector<fftwf_complex*> buffers;    // one tile per worker
+    fftwf_plan forward;
+    fftwf_plan inverse;
+    fftwf_plan forward_tail;
+    fftwf_plan inverse_tail;
+};
+
+// Pick the block transform size for a filter length. Each block costs a
+// forward and an inverse FFT plus a multiply and yields N - taps + 1 samples;
+// candidates start at twice the filter length and grow while the block and
+// the filter spectrum still fit in L2 together, and no further than a single
+// block covering the whole signal.
+static size_t choose_fft_size(size_t taps, size_t signal_length) {
+    size_t budget = cache_size(2);
+    size_t first = next_pow2(2 * taps);
+    size_t whole = next_pow2(signal_length + taps - 1);
+    size_t best = first;
+    double best_cost = 0.0;
+
+    for (size_t n = first; n <= (static_cast<size_t>(1) << 24); n <<= 1) {
+        if (n > first && (2 * n * sizeof(fftwf_complex) > budget || n > whole)) {
+            break;
+        }
+        double nd = static_cast<double>(n);
+        double cost = (2.0 * 5.0 * nd * std::log2(nd) + 6.0 * nd) /
+                      static_cast<double>(n - taps + 1);
+        if (n == first || cost < best_cost) {
+            best = n;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+static fftwf_plan plan_blocks(const ConvPlan& cp, size_t count, fftwf_complex* in,
+                              size_t idist, fftwf_complex* out, int sign, unsigned flags) {
+    int n[] = {static_cast<int>(cp.fft_size)};
+    return fftwf_plan_many_dft(
+        1, n, static_cast<int>(count),
+        in, NULL, 1, static_cast<int>(idist),
+        out, NULL, 1, static_cast<int>(cp.fft_size),
+        sign, flags);
+}
+
+// Block geometry and input layout, needed before the input can be allocated
+static void size_conv_plan(ConvPlan& cp, const Args& args) {
+    cp.overlap_add = args.method == "add";
+    cp.batch = args.batch;
+    cp.signal_length = args.length;
+    cp.taps = args.taps;
+    cp.fft_size = args.fft_size > 0 ? args.fft_size : choose_fft_size(cp.taps, cp.signal_length);
+    cp.step = cp.fft_size - cp.taps + 1;
+    cp.blocks = (cp.signal_length + cp.step - 1) / cp.step;
+
+    // Overlap-save reads overlapping blocks in place, so each signal is stored
+    // behind taps - 1 samples of (zero) history and padded to whole blocks.
+    // Overlap-add copies each block into the tile with its zero padding.
+    if (cp.overlap_add) {
+        cp.input_stride = cp.signal_length;
+        cp.input_offset = 0;
+    } else {
+        cp.input_stride = (cp.blocks - 1) * cp.step + cp.fft_size;
+        cp.input_offset = cp.taps - 1;
+    }
+
+    size_t block_bytes = cp.fft_size * sizeof(fftwf_complex);
+    cp.tile = std::max<size_t>(1, cache_size(2) / 2 / block_bytes);
+    cp.tile = std::min(cp.tile, cp.blocks);
+    cp.workers = std::min<size_t>(static_cast<size_t>(args.threads), cp.batch);
+    cp.filter = NULL;
+    cp.forward = NULL;
+    cp.inverse = NULL;
+    cp.forward_tail = NULL;
+    cp.inverse_tail = NULL;
+}
+
+static bool create_conv_plan(ConvPlan& cp, const Args& args, fftwf_complex* in, const float* h) {
+    cp.filter = fftwf_alloc_complex(cp.fft_size);
+    for (size_t i = 0; i < cp.workers; i++) {
+        cp.buffers.push_back(fftwf_alloc_complex(cp.tile * cp.fft_size));
+    }
+
+    // The workers provide the parallelism, so the plans are single-threaded
+    fftwf_plan_with_nthreads(1);
+
+    unsigned flags = FFTW_MEASURE;
+    if (!cp.overlap_add &&
+        (!keeps_alignment(cp.input_stride) || !keeps_alignment(cp.tile * cp.step))) {
+        flags |= FFTW_UNALIGNED;
+    }
+
+    size_t tail = cp.blocks % cp.tile;
+    fftwf_complex* buffer = cp.buffers[0];
+    if (cp.overlap_add) {
+        cp.forward = plan_blocks(cp, cp.tile, buffer, cp.fft_size, buffer, FFTW_FORWARD, flags);
+    } else {
+        cp.forward = plan_blocks(cp, cp.tile, in, cp.step, buffer, FFTW_FORWARD, flags);
+    }
+    cp.inverse = plan_blocks(cp, cp.tile, buffer, cp.fft_size, buffer, FFTW_BACKWARD, flags);
+    if (tail > 0) {
+        if (cp.overlap_add) {
+            cp.forward_tail = plan_blocks(cp, tail, buffer, cp.fft_size, buffer, FFTW_FORWARD, flags);
+        } else {
+            cp.forward_tail = plan_blocks(cp, tail, in, cp.step, buffer, FFTW_FORWARD, flags);
+        }
+        cp.inverse_tail = plan_blocks(cp, tail, buffer, cp.fft_size, buffer, FFTW_BACKWARD, flags);
+    }
+
+    // Cache the filter spectrum, with the 1/N of the inverse folded in
+    fftwf_plan filter_plan = fftwf_plan_dft_1d(static_cast<int>(cp.fft_size), cp.filter,
+                                               cp.filter, FFTW_FORWARD, FFTW_ESTIMATE);
+    fftwf_plan_with_nthreads(args.threads);
+    if (filter_plan == NULL) {
+        return false;
+    }
+
+    float scale = 1.0f / static_cast<float>(cp.fft_size);
+    for (size_t i = 0; i < cp.fft_size; i++) {
+        cp.filter[i][0] = i < cp.taps ? h[i] * scale : 0.0f;
+        cp.filter[i][1] = 0.0f;
+    }
+    fftwf_execute(filter_plan);
+    fftwf_destroy_plan(filter_plan);
+
+    return cp.forward != NULL && cp.inverse != NULL &&
+           (tail == 0 || (cp.forward_tail != NULL && cp.inverse_tail != NULL));
+}
+
+static void destroy_conv_plan(ConvPlan& cp) {
+    fftwf_plan plans[] = {cp.forward, cp.inverse, cp.forward_tail, cp.inverse_tail};
+    for (size_t i = 0; i < 4; i++) {
+        if (plans[i] != NULL) {
+            fftwf_destroy_plan(plans[i]);
+        }
+    }
+    for (size_t i = 0; i < cp.buffers.size(); i++) {
+        fftwf_free(cp.buffers[i]);
+    }
+    fftwf_free(cp.filter);
+}
+
+// Filter signals id, id + workers, ... Whole signals go to one worker so
+// overlap-add tails never race with the neighbouring block.
+static void conv_worker(const ConvPlan& cp, fftwf_complex* in, fftwf_complex* out, size_t id) {
+    const size_t n = cp.fft_size;
+    const size_t history = cp.taps - 1;
+    fftwf_complex* buffer = cp.buffers[id];
+
+    for (size_t s = id; s < cp.batch; s += cp.workers) {
+        fftwf_complex* x = in + s * cp.input_stride;
+        fftwf_complex* y = out + s * cp.signal_length;
+
+        for (size_t b = 0; b < cp.blocks; b += cp.tile) {
+            size_t count = std::min(cp.tile, cp.blocks - b);
+            bool full = count == cp.tile;
+
+            if (cp.overlap_add) {
+                for (size_t j = 0; j < count; j++) {
+                    size_t start = (b + j) * cp.step;
+                    size_t valid = std::min(cp.step, cp.signal_length - start);
+                    memcpy(buffer + j * n, x + start, valid * sizeof(fftwf_complex));
+                    memset(buffer + j * n + valid, 0, (n - valid) * sizeof(fftwf_complex));
+                }
+                fftwf_execute_dft(full ? cp.forward : cp.forward_tail, buffer, buffer);
+            } else {
+                fftwf_execute_dft(full ? cp.forward : cp.forward_tail, x + b * cp.step, buffer);
+            }
+
+            for (size_t j = 0; j < count; j++) {
+                multiply_spectrum(buffer + j * n, cp.filter, n);
+            }
+            fftwf_execute_dft(full ? cp.inverse : cp.inverse_tail, buffer, buffer);
+
+            for (size_t j = 0; j < count; j++) {
+                size_t start = (b + j) * cp.step;
+                const fftwf_complex* block = buffer + j * n;
+
+                if (cp.overlap_add) {
+                    // The first taps - 1 samples overlap the previous block's tail
+                    size_t valid = std::min(n, cp.signal_length - start);
+                    size_t overlap = start == 0 ? 0 : std::min(history, valid);
+                    for (size_t i = 0; i < overlap; i++) {
+                        y[start + i][0] += block[i][0];
+                        y[start + i][1] += block[i][1];
+                    }
+                    memcpy(y + start + overlap, block + overlap,
+                           (valid - overlap) * sizeof(fftwf_complex));
+                } else {
+                    // The first taps - 1 samples are circularly wrapped: discard
+                    size_t valid = std::min(cp.step, cp.signal_length - start);
+                    memcpy(y + start, block + history, valid * sizeof(fftwf_complex));
+                }
+            }
+        }
+    }
+}
+
+static void execute_conv(const ConvPlan& cp, fftwf_complex* in, fftwf_complex* out) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < cp.workers; id++) {
+        pool.push_back(std::thread(conv_worker, std::cref(cp), in, out, id));
+    }
+    conv_worker(cp, in, out, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+int run_conv(const Args& args) {
+    if (args.taps == 0) {
+        std::cerr << "Error: conv mode needs --taps\n";
+        return 1;
+    }
+    if (!args.method.empty() && args.method != "save" && args.method != "add") {
+        std::cerr << "Error: --method must be save or add\n";
+        return 1;
+    }
+    if (args.fft_size > 0 && args.fft_size < args.taps) {
+        std::cerr << "Error: --fft-size must be at least the filter length\n";
+        return 1;
+    }
+
+    // Windowed-sinc low-pass filter at a quarter of the sample rate
+    std::vector<float> h(args.taps);
+    std::vector<float> hann(args.taps);
+    CosineWindow window;
+    parse_window("hann", window);
+    fill_window(window, hann.data(), args.taps);
+    for (size_t k = 0; k < args.taps; k++) {
+        double t = static_cast<double>(k) - 0.5 * static_cast<double>(args.taps - 1);
+        double sinc = t == 0.0 ? 1.0 : std::sin(0.5 * M_PI * t) / (0.5 * M_PI * t);
+        h[k] = static_cast<float>(0.5 * sinc) * (args.taps > 1 ? hann[k] : 1.0f);
+    }
+
+    ConvPlan cp;
+    size_conv_plan(cp, args);
+    fftwf_complex* in = fftwf_alloc_complex(args.batch * cp.input_stride);
+    fftwf_complex* out = fftwf_alloc_complex(args.batch * args.length);
+
+    // Planned before the input is generated because FFTW_MEASURE overwrites it
+    if (!create_conv_plan(cp, args, in, h.data())) {
+        std::cerr << "Error: FFTW could not create the convolution plans\n";
+        destroy_conv_plan(cp);
+        fftwf_free(in);
+        fftwf_free(out);
+        return 1;
+    }
+
+    // Generate sample data: two tones per signal, one in and one out of the passband
+    memset(in, 0, args.batch * cp.input_stride * sizeof(fftwf_complex));
+    for (size_t s = 0; s < cp.batch; s++) {
+        fftwf_complex* x = in + s * cp.input_stride + cp.input_offset;
+        float freq = 1.0f + static_cast<float>(s % 64);
+        for (size_t i = 0; i < cp.signal_length; i++) {
+            float t = static_cast<float>(i) / 1024.0f;
+            x[i][0] = std::cos(2.0f * M_PI * freq * t) + std::cos(2.0f * M_PI * 400.0f * t);
+            x[i][1] = 0.0f;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_conv(cp, in, out);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    // Direct convolution of a window of the first signal, sized to a fixed
+    // amount of work; gives the baseline rate and the reference output. The
+    // window starts once the filter fully overlaps the signal where possible.
+    size_t count = std::max<size_t>(1024, (static_cast<size_t>(1) << 26) / cp.taps);
+    count = std::min(count, cp.signal_length);
+    size_t first = std::min(cp.taps - 1, cp.signal_length - count);
+    size_t history_length = cp.taps - 1 + count;
+    fftwf_complex* history = fftwf_alloc_complex(history_length);
+    fftwf_complex* reference = fftwf_alloc_complex(count);
+    const fftwf_complex* x = in + cp.input_offset;
+    for (size_t i = 0; i < history_length; i++) {
+        bool inside = first + i >= cp.taps - 1;
+        history[i][0] = inside ? x[first + i - (cp.taps - 1)][0] : 0.0f;
+        history[i][1] = inside ? x[first + i - (cp.taps - 1)][1] : 0.0f;
+    }
+
+    auto direct_start = std::chrono::high_resolution_clock::now();
+    direct_convolve(history, h.data(), cp.taps, reference, count);
+    auto direct_end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> direct_duration = direct_end - direct_start;
+
+    double max_error = 0.0;
+    double max_reference = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double dr = out[first + i][0] - reference[i][0];
+        double di = out[first + i][1] - reference[i][1];
+        max_error = std::max(max_error, std::sqrt(dr * dr + di * di));
+        max_reference = std::max(max_reference, std::sqrt(
+            static_cast<double>(reference[i][0]) * reference[i][0] +
+            static_cast<double>(reference[i][1]) * reference[i][1]));
+    }
+
+    // Calculate performance metrics
+    double time_ms = duration.count() * 1000.0;
+    double samples_per_sec = static_cast<double>(cp.batch * cp.signal_length) / duration.count();
+    double direct_samples_per_sec = static_cast<double>(count) / direct_duration.count();
+
+    // Output results as CSV
+    std::cout << "batch,signal_length,taps,method,fft_size,threads,time_ms,"
+                 "samples_per_sec,direct_samples_per_sec,speedup,max_error\n";
+    std::cout << cp.batch << "," << cp.signal_length << "," << cp.taps << ","
+              << (cp.overlap_add ? "add" : "save") << "," << cp.fft_size << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << samples_per_sec << ","
+              << std::fixed << std::setprecision(0) << direct_samples_per_sec << ","
+              << std::fixed << std::setprecision(1) << samples_per_sec / direct_samples_per_sec << ","
+              << std::scientific << std::setprecision(2)
+              << (max_reference > 0.0 ? max_error / max_reference : max_error) << "\n";
+
+    // Cleanup
+    destroy_conv_plan(cp);
+    fftwf_free(in);
+    fftwf_free(out);
+    fftwf_free(history);
+    fftwf_free(reference);
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef BATCH_FFT_CONV_H
+#define BATCH_FFT_CONV_H
+
+#include "common.h"
+
+// Fast FIR filtering of `batch` signals of `length` samples with a `taps`-long
+// filter, by overlap-save (default) or overlap-add.
+//
+// The filter spectrum is computed once per plan. Each block of signal goes
+// through a batched forward transform, a complex multiply by the cached
+// spectrum and a batched inverse, a cache-sized tile of blocks at a time.
+// The block transform size is chosen from the filter length and L2 size
+// unless given with --fft-size. The first output samples are also computed
+// by direct convolution, for comparison and as an accuracy check.
+int run_conv(const Args& args);
+
+#endif // BATCH_FFT_CONV_H
@@ -0,0 +1,20 @@
+#ifndef BATCH_FFT_CSD_H
+#define BATCH_FFT_CSD_H
+
+#include "common.h"
+
+// Cross-spectral density matrix of `channels` C signals, each cut into
+// `batch` windowed frames of `length` samples advanced by `hop` as in welch:
+//   S[k] = 1/F · Σ_f X_f[k] X_f[k]^H,  a C × C Hermitian matrix per bin
+// Output is bin-major, each matrix packed as its upper triangle of
+// C(C + 1)/2 complex values.
+//
+// Workers transform tiles of frames of all C channels. --method blocked
+// (default) then sums the tile's frames for each channel pair in registers,
+// vectorized along the bins and walking the bins in chunks that stay in L2,
+// so each accumulator is loaded and stored once per tile; --method pairs
+// adds every frame's products into the pair sums, streaming them through
+// cache once per frame. Each method is timed against the other.
+int run_csd(const Args& args);
+
+#endif // BATCH_FFT_CSD_H
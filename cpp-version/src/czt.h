@@ -0,0 +1,60 @@
+#ifndef BATCH_FFT_CZT_H
+#define BATCH_FFT_CZT_H
+
+#include "common.h"
+
+#include <vector>
+#include <fftw3.h>
+
+// Chirp-Z zoom transform: `bins` equally spaced bins over
+// [band_start, band_end) (cycles/sample) of each of `batch` signals of
+// `length` samples,
+//   X[k] = Σ_n x[n] e^(-2πi(f0 + k·df)n),  df = (band_end - band_start) / bins
+//
+// Bluestein's identity nk = (n² + k² - (k - n)²) / 2 turns this into a
+// convolution with a chirp of length L >= length + bins - 1: premultiply by
+// the cached input chirp, batched forward FFT, multiply by the cached
+// chirp-filter spectrum, batched inverse FFT, postmultiply. The filter
+// spectrum (the third FFT) is computed once per configuration.
+//
+// The chirp-Z core below is shared with batch mode, which uses it with
+// f0 = 0 and df = 1/length as Bluestein's algorithm for large prime lengths.
+struct ChirpZ {
+    size_t batch;
+    size_t length;          // N input samples
+    size_t bins;            // M output bins
+    size_t fft_size;        // L >= N + M - 1, power of two or 7-smooth
+    double start;           // f0
+    double spacing;         // df
+    size_t tile;            // signals per batched pass
+    size_t workers;
+    fftwf_complex* pre;     // e^(-2πi·f0·n) · e^(-πi·df·n²), n < N
+    fftwf_complex* post;    // e^(-πi·df·k²), k < M
+    fftwf_complex* filter;  // FFT of the chirp e^(πi·df·m²), scaled by 1/L
+    std::vector<fftwf_complex*> buffers;    // one tile per worker
+    fftwf_plan forward;
+    fftwf_plan inverse;
+    fftwf_plan forward_single;
+    fftwf_plan inverse_single;
+};
+
+// Plan `bins` bins from `start` in steps of `spacing` cycles/sample for
+// `batch` signals of `length` samples on up to `threads` workers. Returns
+// false if FFTW could not create a plan; destroy_chirp_z must still be called.
+bool create_chirp_z(ChirpZ& cz, size_t batch, size_t length, size_t bins,
+                    double start, double spacing, int threads);
+
+// Full length-point DFT of each signal through the chirp-Z core
+bool create_bluestein(ChirpZ& cz, size_t batch, size_t length, int threads);
+
+// Transform `batch` signals from `in` (length apart) into `out` (bins
+// apart). `in` may equal `out` when bins == length.
+void execute_chirp_z(const ChirpZ& cz, const fftwf_complex* in, fftwf_complex* out);
+
+void destroy_chirp_z(ChirpZ& cz);
+
+// For comparison the same band is also computed the way it is done without
+// a zoom transform: a zero-padded FFT long enough for a bin spacing <= df.
+int run_czt(const Args& args);
+
+#endif // BATCH_FFT_CZT_H
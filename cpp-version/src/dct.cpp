@@ -0,0 +1,400 @@
+#include "dct.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+struct DctKind {
+    const char* name;
+    fftwf_r2r_kind r2r;
+    bool type3;         // DCT-III/DST-III (inverse direction)
+    bool sine;
+};
+
+static const DctKind KINDS[] = {
+    {"dct2", FFTW_REDFT10, false, false},
+    {"dct3", FFTW_REDFT01, true, false},
+    {"dst2", FFTW_RODFT10, false, true},
+    {"dst3", FFTW_RODFT01, true, true},
+};
+
+struct DctPlan {
+    DctKind kind;
+    bool emulate;           // Makhoul emulation through a real-input FFT
+    size_t batch;
+    size_t length;          // N
+    size_t half;            // N/2 + 1 complex bins of the real FFT
+    size_t dist;            // half rounded up to even, keeps each spectrum 16-byte aligned
+    size_t tile;            // signals per batched pass
+    size_t workers;
+    fftwf_complex* twiddle; // e^(-iπk/2N), k < N
+    float* inv_step;        // 1 / quantization step per coefficient
+    std::vector<float*> reals;              // tile × N per worker
+    std::vector<fftwf_complex*> spectra;    // tile × dist per worker
+    fftwf_plan plan;        // r2r in → out, r2c reals → spectra or c2r spectra → reals
+    fftwf_plan single;
+};
+
+static bool find_kind(const std::string& name, DctKind& kind) {
+    for (size_t i = 0; i < sizeof(KINDS) / sizeof(KINDS[0]); i++) {
+        if (name == KINDS[i].name) {
+            kind = KINDS[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static fftwf_plan plan_tile(const DctPlan& dp, size_t count, float* in, float* out,
+                            float* real, fftwf_complex* spectrum) {
+    const int n[] = {static_cast<int>(dp.length)};
+    const int len = static_cast<int>(dp.length);
+    const int dist = static_cast<int>(dp.dist);
+    // Tiles start at multiples of N floats, 16-byte aligned only if N % 4 == 0
+    const unsigned flags = dp.length % 4 == 0 ? FFTW_MEASURE : FFTW_MEASURE | FFTW_UNALIGNED;
+    if (!dp.emulate) {
+        fftwf_r2r_kind kinds[] = {dp.kind.r2r};
+        return fftwf_plan_many_r2r(1, n, static_cast<int>(count), in, NULL, 1, len,
+                                   out, NULL, 1, len, kinds, flags);
+    }
+    if (dp.kind.type3) {
+        return fftwf_plan_many_dft_c2r(1, n, static_cast<int>(count), spectrum, NULL, 1, dist,
+                                       real, NULL, 1, len, flags);
+    }
+    return fftwf_plan_many_dft_r2c(1, n, static_cast<int>(count), real, NULL, 1, len,
+                                   spectrum, NULL, 1, dist, flags);
+}
+
+static bool create_dct_plan(DctPlan& dp, const Args& args, const DctKind& kind, bool emulate,
+                            float* in, float* out) {
+    dp.kind = kind;
+    dp.emulate = emulate;
+    dp.batch = args.batch;
+    dp.length = args.length;
+    dp.half = dp.length / 2 + 1;
+    dp.dist = (dp.half + 1) & ~static_cast<size_t>(1);
+
+    const size_t n = dp.length;
+    size_t signal_bytes = n * sizeof(float) + (emulate ? dp.dist * sizeof(fftwf_complex) : 0);
+    dp.tile = std::max<size_t>(1, cache_size(2) / 2 / signal_bytes);
+    dp.tile = std::min(dp.tile, dp.batch);
+    dp.workers = std::min<size_t>(static_cast<size_t>(args.threads),
+                                  (dp.batch + dp.tile - 1) / dp.tile);
+
+    dp.twiddle = fftwf_alloc_complex(n);
+    dp.inv_step = fftwf_alloc_real(n);
+    for (size_t k = 0; k < n; k++) {
+        double angle = -M_PI * static_cast<double>(k) / (2.0 * static_cast<double>(n));
+        dp.twiddle[k][0] = static_cast<float>(std::cos(angle));
+        dp.twiddle[k][1] = static_cast<float>(std::sin(angle));
+        double step = args.quant_step * (1.0 + 4.0 * static_cast<double>(k) / static_cast<double>(n));
+        dp.inv_step[k] = step > 0.0 ? static_cast<float>(1.0 / step) : 0.0f;
+    }
+    for (size_t i = 0; i < dp.workers; i++) {
+        dp.reals.push_back(fftwf_alloc_real(dp.tile * n));
+        dp.spectra.push_back(emulate ? fftwf_alloc_complex(dp.tile * dp.dist) : NULL);
+    }
+
+    // Single-threaded tile plans, the workers run them in parallel
+    fftwf_plan_with_nthreads(1);
+    dp.plan = plan_tile(dp, dp.tile, in, out, dp.reals[0], dp.spectra[0]);
+    dp.single = plan_tile(dp, 1, in, out, dp.reals[0], dp.spectra[0]);
+    fftwf_plan_with_nthreads(args.threads);
+
+    return dp.plan != NULL && dp.single != NULL;
+}
+
+static void destroy_dct_plan(DctPlan& dp) {
+    if (dp.plan != NULL) {
+        fftwf_destroy_plan(dp.plan);
+    }
+    if (dp.single != NULL) {
+        fftwf_destroy_plan(dp.single);
+    }
+    for (size_t i = 0; i < dp.reals.size(); i++) {
+        fftwf_free(dp.reals[i]);
+        if (dp.spectra[i] != NULL) {
+            fftwf_free(dp.spectra[i]);
+        }
+    }
+    fftwf_free(dp.twiddle);
+    fftwf_free(dp.inv_step);
+}
+
+// Makhoul pre-processing of one signal: DCT-II/DST-II reorder into a real
+// row, DCT-III/DST-III twiddle into a half spectrum
+static void makhoul_pre(const DctPlan& dp, const float* x, float* v, fftwf_complex* c) {
+    const size_t n = dp.length;
+    if (!dp.kind.type3) {
+        // Even samples forward, odd samples backward; DST-II alternates signs
+        const float odd = dp.kind.sine ? -1.0f : 1.0f;
+        for (size_t m = 0; 2 * m < n; m++) {
+            v[m] = x[2 * m];
+        }
+        for (size_t m = 0; 2 * m + 1 < n; m++) {
+            v[n - 1 - m] = odd * x[2 * m + 1];
+        }
+        return;
+    }
+    // V[k] = conj(t[k]) · (x[k] - i·x[N-k]), x[N] = 0; DST-III reverses x
+    for (size_t k = 0; k < dp.half; k++) {
+        float a = dp.kind.sine ? x[n - 1 - k] : x[k];
+        float b = k == 0 ? 0.0f : (dp.kind.sine ? x[k - 1] : x[n - k]);
+        float tr = dp.twiddle[k][0];
+        float ti = -dp.twiddle[k][1];
+        c[k][0] = tr * a + ti * b;
+        c[k][1] = ti * a - tr * b;
+    }
+}
+
+// Makhoul post-processing of one signal into y
+static void makhoul_post(const DctPlan& dp, const float* v, const fftwf_complex* c, float* y) {
+    const size_t n = dp.length;
+    if (!dp.kind.type3) {
+        // Y[k] = 2·Re(t[k]·C[k]) with C[k] = conj(C[N-k]) above N/2; DST-II reverses Y
+        for (size_t k = 0; k < n; k++) {
+            float value;
+            if (k < dp.half) {
+                value = 2.0f * (dp.twiddle[k][0] * c[k][0] - dp.twiddle[k][1] * c[k][1]);
+            } else {
+                value = 2.0f * (dp.twiddle[k][0] * c[n - k][0] + dp.twiddle[k][1] * c[n - k][1]);
+            }
+            y[dp.kind.sine ? n - 1 - k : k] = value;
+        }
+        return;
+    }
+    // y[2m] = v[m], y[2m+1] = v[N-1-m]; DST-III alternates signs
+    const float odd = dp.kind.sine ? -1.0f : 1.0f;
+    for (size_t m = 0; 2 * m < n; m++) {
+        y[2 * m] = v[m];
+    }
+    for (size_t m = 0; 2 * m + 1 < n; m++) {
+        y[2 * m + 1] = odd * v[n - 1 - m];
+    }
+}
+
+// Tiles id, id + workers, ...: transform into `out`, or with `q` quantize
+// each tile while it is in cache
+static void dct_worker(const DctPlan& dp, const float* in, float* out, int16_t* q, size_t id) {
+    const size_t n = dp.length;
+    const size_t tiles = (dp.batch + dp.tile - 1) / dp.tile;
+    float* real = dp.reals[id];
+    fftwf_complex* spectrum = dp.spectra[id];
+
+    for (size_t t = id; t < tiles; t += dp.workers) {
+        size_t first = t * dp.tile;
+        size_t count = std::min(dp.tile, dp.batch - first);
+        bool full = count == dp.tile;
+        const float* x = in + first * n;
+        float* y = q != NULL ? real : out + first * n;
+
+        if (!dp.emulate) {
+            if (full) {
+                fftwf_execute_r2r(dp.plan, const_cast<float*>(x), y);
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    fftwf_execute_r2r(dp.single, const_cast<float*>(x + j * n), y + j * n);
+                }
+            }
+        } else if (!dp.kind.type3) {
+            for (size_t j = 0; j < count; j++) {
+                makhoul_pre(dp, x + j * n, real + j * n, NULL);
+            }
+            if (full) {
+                fftwf_execute_dft_r2c(dp.plan, real, spectrum);
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    fftwf_execute_dft_r2c(dp.single, real + j * n, spectrum + j * dp.dist);
+                }
+            }
+            // The reordered input is dead, so y may be the real tile
+            for (size_t j = 0; j < count; j++) {
+                makhoul_post(dp, NULL, spectrum + j * dp.dist, y + j * n);
+            }
+        } else {
+            for (size_t j = 0; j < count; j++) {
+                makhoul_pre(dp, x + j * n, NULL, spectrum + j * dp.dist);
+            }
+            if (full) {
+                fftwf_execute_dft_c2r(dp.plan, spectrum, real);
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    fftwf_execute_dft_c2r(dp.single, spectrum + j * dp.dist, real + j * n);
+                }
+            }
+            // The consumed spectrum tile holds the reordered rows
+            float* rows = q != NULL ? reinterpret_cast<float*>(spectrum) : y;
+            for (size_t j = 0; j < count; j++) {
+                makhoul_post(dp, real + j * n, NULL, rows + j * n);
+            }
+            y = rows;
+        }
+
+        if (q != NULL) {
+            for (size_t j = 0; j < count; j++) {
+                quantize(y + j * n, dp.inv_step, q + (first + j) * n, n);
+            }
+        }
+    }
+}
+
+// Separate quantization pass over signals id, id + workers, ...
+static void quantize_worker(const DctPlan& dp, const float* out, int16_t* q, size_t id) {
+    for (size_t s = id; s < dp.batch; s += dp.workers) {
+        quantize(out + s * dp.length, dp.inv_step, q + s * dp.length, dp.length);
+    }
+}
+
+static void execute_dct(const DctPlan& dp, const float* in, float* out, int16_t* q) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < dp.workers; id++) {
+        pool.push_back(std::thread(dct_worker, std::cref(dp), in, out, q, id));
+    }
+    dct_worker(dp, in, out, q, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+static void execute_quantize(const DctPlan& dp, const float* out, int16_t* q) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < dp.workers; id++) {
+        pool.push_back(std::thread(quantize_worker, std::cref(dp), out, q, id));
+    }
+    quantize_worker(dp, out, q, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+int run_dct(const Args& args) {
+    DctKind kind;
+    if (!find_kind(args.kind.empty() ? "dct2" : args.kind, kind)) {
+        std::cerr << "Error: --kind must be dct2, dct3, dst2 or dst3\n";
+        return 1;
+    }
+    std::string method = args.method.empty() ? "fft" : args.method;
+    if (method != "fft" && method != "r2r") {
+        std::cerr << "Error: dct --method must be fft or r2r\n";
+        return 1;
+    }
+    if (args.quant_step < 0.0) {
+        std::cerr << "Error: --quant must be positive\n";
+        return 1;
+    }
+    const bool quant = args.quant_step > 0.0;
+
+    const size_t n = args.length;
+    const size_t total_size = args.batch * n;
+    float* in = fftwf_alloc_real(total_size);
+    float* out = fftwf_alloc_real(total_size);
+    float* reference = fftwf_alloc_real(total_size);
+    int16_t* q = quant ? new int16_t[total_size] : NULL;
+
+    // Plans first, FFTW_MEASURE overwrites the arrays. The other method is
+    // the baseline.
+    DctPlan dp;
+    DctPlan baseline;
+    const bool emulate = method == "fft";
+    bool planned = create_dct_plan(dp, args, kind, emulate, in, out);
+    planned = create_dct_plan(baseline, args, kind, !emulate, in, reference) && planned;
+    if (!planned) {
+        std::cerr << "Error: FFTW could not create the " << kind.name << " plans\n";
+        destroy_dct_plan(dp);
+        destroy_dct_plan(baseline);
+        fftwf_free(in);
+        fftwf_free(out);
+        fftwf_free(reference);
+        delete[] q;
+        return 1;
+    }
+
+    // Generate sample data: two tones and a slow ramp, smooth enough that the
+    // energy compacts into the low coefficients
+    for (size_t s = 0; s < args.batch; s++) {
+        for (size_t i = 0; i < n; i++) {
+            double t = static_cast<double>(i) / static_cast<double>(n);
+            double f = 3.0 + static_cast<double>(s % 17);
+            in[s * n + i] = static_cast<float>(std::cos(2.0 * M_PI * f * t) +
+                                               0.25 * std::sin(2.0 * M_PI * 4.0 * f * t) + t);
+        }
+    }
+
+    // Fault the outputs in so no timed run pays for first touch
+    memset(out, 0, total_size * sizeof(float));
+    memset(reference, 0, total_size * sizeof(float));
+    if (quant) {
+        memset(q, 0, total_size * sizeof(int16_t));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_dct(dp, in, out, NULL);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto baseline_start = std::chrono::high_resolution_clock::now();
+    execute_dct(baseline, in, reference, NULL);
+    auto baseline_end = std::chrono::high_resolution_clock::now();
+
+    // Quantized: fused into the tiles, then float output plus a separate pass
+    double quant_time_ms = 0.0;
+    double unfused_time_ms = 0.0;
+    if (quant) {
+        auto quant_start = std::chrono::high_resolution_clock::now();
+        execute_dct(dp, in, out, q);
+        auto quant_end = std::chrono::high_resolution_clock::now();
+        quant_time_ms = std::chrono::duration<double>(quant_end - quant_start).count() * 1000.0;
+
+        auto unfused_start = std::chrono::high_resolution_clock::now();
+        execute_dct(dp, in, out, NULL);
+        execute_quantize(dp, out, q);
+        auto unfused_end = std::chrono::high_resolution_clock::now();
+        unfused_time_ms = std::chrono::duration<double>(unfused_end - unfused_start).count() * 1000.0;
+    }
+
+    // Check the first signal against the other method, relative to 2·Σ|x|
+    double bound = 0.0;
+    double max_error = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        bound += 2.0 * std::fabs(in[i]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        max_error = std::max(max_error, std::fabs(out[i] - reference[i]) / bound);
+    }
+
+    // Calculate performance metrics
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double baseline_time_ms = std::chrono::duration<double>(baseline_end - baseline_start).count() * 1000.0;
+    double transforms_per_sec = static_cast<double>(args.batch) / duration.count();
+
+    // Output results as CSV
+    std::cout << "batch,length,kind,method,threads,time_ms,transforms_per_sec,baseline_time_ms,speedup,"
+                 "quant_step,quant_time_ms,unfused_time_ms,max_error\n";
+    std::cout << args.batch << "," << n << "," << kind.name << "," << method << ","
+              << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << transforms_per_sec << ","
+              << std::fixed << std::setprecision(3) << baseline_time_ms << ","
+              << std::fixed << std::setprecision(2) << baseline_time_ms / time_ms << ","
+              << std::defaultfloat << std::setprecision(6) << args.quant_step << ","
+              << std::fixed << std::setprecision(3) << quant_time_ms << ","
+              << std::fixed << std::setprecision(3) << unfused_time_ms << ","
+              << std::scientific << std::setprecision(2) << max_error << "\n";
+
+    // Cleanup
+    destroy_dct_plan(dp);
+    destroy_dct_plan(baseline);
+    fftwf_free(in);
+    fftwf_free(out);
+    fftwf_free(reference);
+    delete[] q;
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef BATCH_FFT_DCT_H
+#define BATCH_FFT_DCT_H
+
+#include "common.h"
+
+// Batched real-to-real transforms of `batch` real signals of `length`
+// samples, in FFTW's unnormalized conventions:
+//   dct2 (REDFT10)  Y[k] = 2 Σ x[n] cos(π(n + ½)k / N)
+//   dct3 (REDFT01)  Y[k] = x[0] + 2 Σ_{n>0} x[n] cos(πn(k + ½) / N)
+//   dst2 (RODFT10)  Y[k] = 2 Σ x[n] sin(π(n + ½)(k + 1) / N)
+//   dst3 (RODFT01)  Y[k] = (-1)^k x[N-1] + 2 Σ_{n<N-1} x[n] sin(π(n + 1)(k + ½) / N)
+//
+// Both methods work on tiles of signals that fit in L2. --method fft
+// (default) runs a length-N real-input FFT with Makhoul's reordering: even
+// samples forward and odd samples backward, then a quarter-sample twiddle
+// (DCT-II), or the reverse (DCT-III). DST-II/III are the DCT of the
+// sign-alternated or reversed signal. --method r2r is fftwf_plan_many_r2r
+// with FFTW's own kinds. Each is timed against the other.
+//
+// --quant q quantizes the output to int16 with steps q·(1 + 4k/N), coarser
+// toward high frequencies as in image codecs, while each tile is still in
+// cache. The same transform written out as floats and quantized in a
+// separate pass is timed for comparison.
+int run_dct(const Args& args);
+
+#endif // BATCH_FFT_DCT_H
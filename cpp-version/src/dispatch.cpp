@@ -0,0 +1,149 @@
+#include "dispatch.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+namespace isa_generic { extern const KernelTable kernel_table; }
+#if defined(__x86_64__) || defined(_M_X64)
+namespace isa_sse3 { extern const KernelTable kernel_table; }
+namespace isa_avx2 { extern const KernelTable kernel_table; }
+namespace isa_avx512 { extern const KernelTable kernel_table; }
+#endif
+
+static const KernelTable* select_kernels() {
+    // Levels from lowest to highest, with whether this CPU runs them
+    const KernelTable* levels[4] = {&isa_generic::kernel_table};
+    bool supported[4] = {true};
+    size_t count = 1;
+#if defined(__x86_64__) || defined(_M_X64)
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    levels[count] = &isa_sse3::kernel_table;
+    supported[count++] = __builtin_cpu_supports("sse3");
+    levels[count] = &isa_avx2::kernel_table;
+    supported[count++] = avx2;
+    levels[count] = &isa_avx512::kernel_table;
+    supported[count++] = avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+                         __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq");
+#endif
+
+    size_t best = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (supported[i]) {
+            best = i;
+        }
+    }
+
+    const char* forced = std::getenv("BATCH_FFT_ISA");
+    if (forced != NULL && forced[0] != '\0') {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(forced, levels[i]->isa) == 0) {
+                if (supported[i]) {
+                    return levels[i];
+                }
+                std::cerr << "Warning: BATCH_FFT_ISA=" << forced << " is not supported by this CPU\n";
+                return levels[best];
+            }
+        }
+        std::cerr << "Warning: unknown BATCH_FFT_ISA=" << forced << ", levels are";
+        for (size_t i = 0; i < count; i++) {
+            std::cerr << " " << levels[i]->isa;
+        }
+        std::cerr << "\n";
+    }
+    return levels[best];
+}
+
+const KernelTable& kernels() {
+    static const KernelTable* table = select_kernels();
+    return *table;
+}
+
+void apply_window(const fftwf_complex* in, const float* w, fftwf_complex* out, size_t n) {
+    kernels().apply_window(in, w, out, n);
+}
+
+void accumulate_power(const fftwf_complex* x, float* sum, size_t n) {
+    kernels().accumulate_power(x, sum, n);
+}
+
+void multiply_complex(const fftwf_complex* x, const fftwf_complex* h, fftwf_complex* y, size_t n) {
+    kernels().multiply_complex(x, h, y, n);
+}
+
+void multiply_spectrum(fftwf_complex* x, const fftwf_complex* h, size_t n) {
+    kernels().multiply_spectrum(x, h, n);
+}
+
+void multiply_conj_spectrum(fftwf_complex* x, const fftwf_complex* y, size_t n, float scale) {
+    kernels().multiply_conj_spectrum(x, y, n, scale);
+}
+
+void complex_dot(const fftwf_complex* a, const fftwf_complex* b, size_t n, fftwf_complex* result) {
+    kernels().complex_dot(a, b, n, result);
+}
+
+void goertzel_update(const fftwf_complex* x, size_t stride, size_t signals, size_t n,
+                     const float* coeffs, size_t bins, float* state) {
+    kernels().goertzel_update(x, stride, signals, n, coeffs, bins, state);
+}
+
+size_t max_power_index(const fftwf_complex* x, size_t begin, size_t end) {
+    return kernels().max_power_index(x, begin, end);
+}
+
+void transpose(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+               fftwf_complex* out, size_t out_stride, size_t prefetch) {
+    kernels().transpose(in, rows, cols, in_stride, out, out_stride, prefetch);
+}
+
+void twiddle_rows(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+                  fftwf_complex* out, size_t out_stride, fftwf_complex* t, const fftwf_complex* step) {
+    kernels().twiddle_rows(in, rows, cols, in_stride, out, out_stride, t, step);
+}
+
+void polyphase_fir(const fftwf_complex* x, const float* h2, size_t taps, size_t channels,
+                   fftwf_complex* y) {
+    kernels().polyphase_fir(x, h2, taps, channels, y);
+}
+
+void cross_accumulate(const fftwf_complex* a, const fftwf_complex* b, size_t count, size_t rows,
+                      size_t stride, size_t dist, size_t n, fftwf_complex* sum) {
+    kernels().cross_accumulate(a, b, count, rows, stride, dist, n, sum);
+}
+
+void magnitude(const fftwf_complex* x, float* y, size_t n) {
+    kernels().magnitude(x, y, n);
+}
+
+void quantize(const float* x, const float* inv_step, int16_t* q, size_t n) {
+    kernels().quantize(x, inv_step, q, n);
+}
+
+unsigned bfp_radix2_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift) {
+    return kernels().bfp_radix2_stage(x, y, n, s, w_re, w_im, shift);
+}
+
+unsigned bfp_radix4_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift) {
+    return kernels().bfp_radix4_stage(x, y, n, s, w_re, w_im, shift);
+}
+
+unsigned max_abs_int16(const int16_t* x, size_t n) {
+    return kernels().max_abs_int16(x, n);
+}
+
+void direct_convolve(const fftwf_complex* x, const float* h, size_t taps, fftwf_complex* y, size_t count) {
+    kernels().direct_convolve(x, h, taps, y, count);
+}
+
+void stream_copy(const fftwf_complex* in, fftwf_complex* out, size_t n) {
+    kernels().stream_copy(in, out, n);
+}
+
+void generate_tones(fftwf_complex* data, size_t batch, size_t length) {
+    kernels().generate_tones(data, batch, length);
+}
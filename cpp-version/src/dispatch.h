@@ -0,0 +1,65 @@
+#ifndef BATCH_FFT_DISPATCH_H
+#define BATCH_FFT_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+#include "fixed_fft.h"
+#include "vertical.h"
+
+// The SIMD code (kernels.cpp, fixed_fft_kernels.cpp, vertical_kernels.cpp)
+// is compiled once per ISA level, each copy in its own namespace
+// BATCH_FFT_ISA (isa_generic, and on x86-64 also isa_sse3, isa_avx2 with
+// FMA and isa_avx512), while everything else is built for the baseline
+// target. The copies must stay free of out-of-line library templates: a
+// weak symbol built with AVX-512 could be the one the linker keeps.
+//
+// One table per level is picked the first time kernels() is called: the
+// highest level cpuid reports, or the level named by the environment
+// variable BATCH_FFT_ISA if this CPU supports it.
+struct KernelTable {
+    const char* isa;
+    void (*apply_window)(const fftwf_complex* in, const float* w, fftwf_complex* out, size_t n);
+    void (*accumulate_power)(const fftwf_complex* x, float* sum, size_t n);
+    void (*multiply_complex)(const fftwf_complex* x, const fftwf_complex* h, fftwf_complex* y, size_t n);
+    void (*multiply_spectrum)(fftwf_complex* x, const fftwf_complex* h, size_t n);
+    void (*multiply_conj_spectrum)(fftwf_complex* x, const fftwf_complex* y, size_t n, float scale);
+    void (*complex_dot)(const fftwf_complex* a, const fftwf_complex* b, size_t n, fftwf_complex* result);
+    void (*goertzel_update)(const fftwf_complex* x, size_t stride, size_t signals, size_t n,
+                            const float* coeffs, size_t bins, float* state);
+    size_t (*max_power_index)(const fftwf_complex* x, size_t begin, size_t end);
+    void (*transpose)(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+                      fftwf_complex* out, size_t out_stride, size_t prefetch);
+    void (*twiddle_rows)(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+                         fftwf_complex* out, size_t out_stride, fftwf_complex* t, const fftwf_complex* step);
+    void (*polyphase_fir)(const fftwf_complex* x, const float* h2, size_t taps, size_t channels,
+                          fftwf_complex* y);
+    void (*cross_accumulate)(const fftwf_complex* a, const fftwf_complex* b, size_t count, size_t rows,
+                             size_t stride, size_t dist, size_t n, fftwf_complex* sum);
+    void (*magnitude)(const fftwf_complex* x, float* y, size_t n);
+    void (*quantize)(const float* x, const float* inv_step, int16_t* q, size_t n);
+    unsigned (*bfp_radix2_stage)(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                                 const int16_t* w_im, unsigned shift);
+    unsigned (*bfp_radix4_stage)(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                                 const int16_t* w_im, unsigned shift);
+    unsigned (*max_abs_int16)(const int16_t* x, size_t n);
+    void (*direct_convolve)(const fftwf_complex* x, const float* h, size_t taps, fftwf_complex* y,
+                            size_t count);
+    void (*stream_copy)(const fftwf_complex* in, fftwf_complex* out, size_t n);
+    void (*generate_tones)(fftwf_complex* data, size_t batch, size_t length);
+    FixedFft (*find_fixed_fft)(size_t length);
+    VerticalGroups (*find_vertical_groups)(size_t length);
+};
+
+const KernelTable& kernels();
+
+#ifdef BATCH_FFT_ISA
+// Defined by each per-ISA copy
+namespace BATCH_FFT_ISA {
+FixedFft find_fixed_fft(size_t length);
+VerticalGroups find_vertical_groups(size_t length);
+extern const KernelTable kernel_table;
+}
+#endif
+
+#endif // BATCH_FFT_DISPATCH_H
@@ -0,0 +1,58 @@
+#include "fixed_fft.h"
+#include "dispatch.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+// Transform signals [first, last) with the worker's own scratch
+static void fixed_worker(const FixedBatch& fb, fftwf_complex* data, size_t first, size_t last,
+                         fftwf_complex* work) {
+    for (size_t s = first; s < last; s++) {
+        fb.fft(data + s * fb.length, work);
+    }
+}
+
+FixedFft find_fixed_fft(size_t length) {
+    return kernels().find_fixed_fft(length);
+}
+
+std::vector<size_t> fixed_fft_lengths() {
+    const size_t lengths[] = {FIXED_FFT_LENGTHS};
+    std::vector<size_t> sorted(lengths, lengths + sizeof(lengths) / sizeof(lengths[0]));
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+bool create_fixed_batch(FixedBatch& fb, size_t batch, size_t length, int threads) {
+    fb.fft = find_fixed_fft(length);
+    fb.batch = batch;
+    fb.length = length;
+    fb.workers = std::min<size_t>(static_cast<size_t>(threads), batch);
+    if (fb.fft == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < fb.workers; i++) {
+        fb.work.push_back(fftwf_alloc_complex(length));
+    }
+    return true;
+}
+
+void execute_fixed_batch(const FixedBatch& fb, fftwf_complex* data) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < fb.workers; id++) {
+        pool.push_back(std::thread(fixed_worker, std::cref(fb), data, fb.batch * id / fb.workers,
+                                   fb.batch * (id + 1) / fb.workers, fb.work[id]));
+    }
+    fixed_worker(fb, data, 0, fb.batch / fb.workers, fb.work[0]);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+void destroy_fixed_batch(FixedBatch& fb) {
+    for (size_t i = 0; i < fb.work.size(); i++) {
+        fftwf_free(fb.work[i]);
+    }
+    fb.work.clear();
+}
@@ -0,0 +1,46 @@
+#ifndef BATCH_FFT_FIXED_FFT_H
+#define BATCH_FFT_FIXED_FFT_H
+
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+// Length-specialized forward FFTs, compiled for each length in the CMake
+// list FIXED_FFT_LENGTHS (default 256;1024;4096). Each is an FFT<N>
+// template: a radix-4 Stockham autosort transform (radix-2 last for odd
+// log2 N) whose twiddle table is a constexpr array and whose stage schedule
+// (strides, butterfly counts, twiddle offsets) is fixed at compile time, so
+// every loop has a constant trip count. Batch mode looks the length up at
+// run time and uses FFTW for any length without a kernel.
+
+// Lengths with a kernel; CMake passes the FIXED_FFT_LENGTHS cache list
+#ifndef FIXED_FFT_LENGTHS
+#define FIXED_FFT_LENGTHS 256, 1024, 4096
+#endif
+
+// x is transformed in place; work holds N scratch values
+typedef void (*FixedFft)(fftwf_complex* x, fftwf_complex* work);
+
+// The kernel for this length, or NULL
+FixedFft find_fixed_fft(size_t length);
+
+// The compiled-in lengths, ascending
+std::vector<size_t> fixed_fft_lengths();
+
+struct FixedBatch {
+    FixedFft fft;
+    size_t batch;
+    size_t length;
+    size_t workers;         // contiguous ranges of signals, one per worker
+    std::vector<fftwf_complex*> work;
+};
+
+// False if no kernel exists for `length`; destroy_fixed_batch must still be called
+bool create_fixed_batch(FixedBatch& fb, size_t batch, size_t length, int threads);
+
+// Transform `batch` contiguous signals in place
+void execute_fixed_batch(const FixedBatch& fb, fftwf_complex* data);
+
+void destroy_fixed_batch(FixedBatch& fb);
+
+#endif // BATCH_FFT_FIXED_FFT_H
@@ -0,0 +1,292 @@
+#include "fixed_fft.h"
+#include "dispatch.h"
+
+#include <array>
+#include <cstring>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace BATCH_FFT_ISA {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series, accurate to double precision for |x| <= π/4
+constexpr double taylor_sin(double x) {
+    double term = x;
+    double sum = x;
+    for (int k = 1; k < 12; k++) {
+        term *= -x * x / ((2.0 * k) * (2.0 * k + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double taylor_cos(double x) {
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 12; k++) {
+        term *= -x * x / ((2.0 * k - 1.0) * (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+struct Root {
+    double re;
+    double im;
+};
+
+// e^(-2πij/n), reduced to an angle of at most π/4 by quadrant and octant
+// symmetry so that the series stays exact
+constexpr Root unit_root(size_t j, size_t n) {
+    j %= n;
+    size_t quadrant = 4 * j / n;
+    size_t r = 4 * j % n;       // angle within the quadrant is (π/2)·r/n
+    double c = 0.0;
+    double s = 0.0;
+    if (2 * r <= n) {
+        double x = PI / 2.0 * static_cast<double>(r) / static_cast<double>(n);
+        c = taylor_cos(x);
+        s = taylor_sin(x);
+    } else {
+        double x = PI / 2.0 * static_cast<double>(n - r) / static_cast<double>(n);
+        c = taylor_sin(x);
+        s = taylor_cos(x);
+    }
+    for (size_t q = 0; q < quadrant; q++) {
+        double t = c;
+        c = -s;
+        s = t;
+    }
+    return Root{c, -s};
+}
+
+// Complex twiddles of all radix-4 stages: for the stage of sub-length n,
+// w^p, w^2p, w^3p for p < n/4 with w = e^(-2πi/n), as three arrays
+constexpr size_t twiddle_count(size_t n) {
+    size_t total = 0;
+    for (; n >= 4; n /= 4) {
+        total += 3 * (n / 4);
+    }
+    return total;
+}
+
+// Complex offset of the stage with stride s = 4^i
+constexpr size_t twiddle_offset(size_t n, size_t s) {
+    size_t offset = 0;
+    for (size_t t = 1; t < s; t *= 4) {
+        offset += 3 * (n / t / 4);
+    }
+    return offset;
+}
+
+template <size_t N>
+constexpr std::array<float, 2 * twiddle_count(N)> make_twiddles() {
+    std::array<float, 2 * twiddle_count(N)> table{};
+    size_t i = 0;
+    for (size_t n = N; n >= 4; n /= 4) {
+        for (size_t k = 1; k <= 3; k++) {
+            for (size_t p = 0; p < n / 4; p++, i++) {
+                Root w = unit_root(k * p, n);
+                table[2 * i] = static_cast<float>(w.re);
+                table[2 * i + 1] = static_cast<float>(w.im);
+            }
+        }
+    }
+    return table;
+}
+
+template <size_t N>
+struct FftTables {
+    static constexpr std::array<float, 2 * twiddle_count(N)> twiddles = make_twiddles<N>();
+};
+
+#if defined(__AVX__)
+// Both floats of the complex value at w as one 64-bit lane, for broadcasting
+inline __m256 broadcast_complex(const float* w) {
+    double bits;
+    memcpy(&bits, w, sizeof(bits));
+    return _mm256_castpd_ps(_mm256_set1_pd(bits));
+}
+
+// a * w for four interleaved complex values
+inline __m256 cmul(__m256 a, __m256 w) {
+    __m256 swapped = _mm256_permute_ps(a, 0xB1);
+#if defined(__FMA__)
+    return _mm256_fmaddsub_ps(a, _mm256_moveldup_ps(w), _mm256_mul_ps(swapped, _mm256_movehdup_ps(w)));
+#else
+    return _mm256_addsub_ps(_mm256_mul_ps(a, _mm256_moveldup_ps(w)),
+                            _mm256_mul_ps(swapped, _mm256_movehdup_ps(w)));
+#endif
+}
+
+// Radix-4 butterfly in place of a, b, c, d; (b - d) is rotated by -i
+inline void butterfly4(__m256& a, __m256& b, __m256& c, __m256& d) {
+    const __m256 odd_sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+    __m256 apc = _mm256_add_ps(a, c);
+    __m256 amc = _mm256_sub_ps(a, c);
+    __m256 bpd = _mm256_add_ps(b, d);
+    __m256 jbmd = _mm256_xor_ps(_mm256_permute_ps(_mm256_sub_ps(b, d), 0xB1), odd_sign);
+    a = _mm256_add_ps(apc, bpd);
+    b = _mm256_add_ps(amc, jbmd);
+    c = _mm256_sub_ps(apc, bpd);
+    d = _mm256_sub_ps(amc, jbmd);
+}
+#endif
+
+// y[q + S(4p + j)] = w^(jp) · Σ_k x[q + S(p + kM)] (-i)^(jk), p < M, q < S,
+// with tw holding w^p, w^2p, w^3p as three arrays of M. The last stage
+// (M = 1) has only trivial twiddles and may run in place.
+template <size_t M, size_t S>
+inline void radix4_stage(const float* x, float* y, const float* tw) {
+    const float* w1 = tw;
+    const float* w2 = tw + 2 * M;
+    const float* w3 = tw + 4 * M;
+#if defined(__AVX__)
+    if constexpr (S >= 4) {
+        // Lanes are q, four independent sub-transforms sharing a twiddle
+        for (size_t p = 0; p < M; p++) {
+            __m256 t1 = broadcast_complex(w1 + 2 * p);
+            __m256 t2 = broadcast_complex(w2 + 2 * p);
+            __m256 t3 = broadcast_complex(w3 + 2 * p);
+            for (size_t q = 0; q < S; q += 4) {
+                __m256 a = _mm256_loadu_ps(x + 2 * (q + S * p));
+                __m256 b = _mm256_loadu_ps(x + 2 * (q + S * (p + M)));
+                __m256 c = _mm256_loadu_ps(x + 2 * (q + S * (p + 2 * M)));
+                __m256 d = _mm256_loadu_ps(x + 2 * (q + S * (p + 3 * M)));
+                butterfly4(a, b, c, d);
+                if (p > 0) {
+                    b = cmul(b, t1);
+                    c = cmul(c, t2);
+                    d = cmul(d, t3);
+                }
+                _mm256_storeu_ps(y + 2 * (q + S * 4 * p), a);
+                _mm256_storeu_ps(y + 2 * (q + S * (4 * p + 1)), b);
+                _mm256_storeu_ps(y + 2 * (q + S * (4 * p + 2)), c);
+                _mm256_storeu_ps(y + 2 * (q + S * (4 * p + 3)), d);
+            }
+        }
+        return;
+    } else if constexpr (M % 4 == 0) {
+        // First stage (S = 1): lanes are p, and the four outputs of each p
+        // are adjacent, so each 4 × 4 block is transposed before the store
+        for (size_t p = 0; p < M; p += 4) {
+            __m256 a = _mm256_loadu_ps(x + 2 * p);
+            __m256 b = _mm256_loadu_ps(x + 2 * (p + M));
+            __m256 c = _mm256_loadu_ps(x + 2 * (p + 2 * M));
+            __m256 d = _mm256_loadu_ps(x + 2 * (p + 3 * M));
+            butterfly4(a, b, c, d);
+            b = cmul(b, _mm256_loadu_ps(w1 + 2 * p));
+            c = cmul(c, _mm256_loadu_ps(w2 + 2 * p));
+            d = cmul(d, _mm256_loadu_ps(w3 + 2 * p));
+            __m256d t0 = _mm256_unpacklo_pd(_mm256_castps_pd(a), _mm256_castps_pd(b));
+            __m256d t1 = _mm256_unpackhi_pd(_mm256_castps_pd(a), _mm256_castps_pd(b));
+            __m256d t2 = _mm256_unpacklo_pd(_mm256_castps_pd(c), _mm256_castps_pd(d));
+            __m256d t3 = _mm256_unpackhi_pd(_mm256_castps_pd(c), _mm256_castps_pd(d));
+            _mm256_storeu_ps(y + 8 * p, _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x20)));
+            _mm256_storeu_ps(y + 8 * (p + 1), _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x20)));
+            _mm256_storeu_ps(y + 8 * (p + 2), _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x31)));
+            _mm256_storeu_ps(y + 8 * (p + 3), _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x31)));
+        }
+        return;
+    }
+#endif
+    for (size_t p = 0; p < M; p++) {
+        for (size_t q = 0; q < S; q++) {
+            const float* a = x + 2 * (q + S * p);
+            const float* b = x + 2 * (q + S * (p + M));
+            const float* c = x + 2 * (q + S * (p + 2 * M));
+            const float* d = x + 2 * (q + S * (p + 3 * M));
+            float u_re[4] = {a[0] + c[0] + b[0] + d[0], a[0] - c[0] + b[1] - d[1],
+                             a[0] + c[0] - b[0] - d[0], a[0] - c[0] - b[1] + d[1]};
+            float u_im[4] = {a[1] + c[1] + b[1] + d[1], a[1] - c[1] - b[0] + d[0],
+                             a[1] + c[1] - b[1] - d[1], a[1] - c[1] + b[0] - d[0]};
+            const float* w[4] = {NULL, w1 + 2 * p, w2 + 2 * p, w3 + 2 * p};
+            float* out = y + 2 * (q + S * 4 * p);
+            out[0] = u_re[0];
+            out[1] = u_im[0];
+            for (int j = 1; j < 4; j++) {
+                out[2 * S * j] = u_re[j] * w[j][0] - u_im[j] * w[j][1];
+                out[2 * S * j + 1] = u_re[j] * w[j][1] + u_im[j] * w[j][0];
+            }
+        }
+    }
+}
+
+// Last stage for odd log2 N: y[q] = x[q] + x[q + S], y[q + S] = x[q] - x[q + S]
+template <size_t S>
+inline void radix2_stage(const float* x, float* y) {
+#if defined(__AVX__)
+    if constexpr (S % 4 == 0) {
+        for (size_t q = 0; q < S; q += 4) {
+            __m256 a = _mm256_loadu_ps(x + 2 * q);
+            __m256 b = _mm256_loadu_ps(x + 2 * (q + S));
+            _mm256_storeu_ps(y + 2 * q, _mm256_add_ps(a, b));
+            _mm256_storeu_ps(y + 2 * (q + S), _mm256_sub_ps(a, b));
+        }
+        return;
+    }
+#endif
+    for (size_t q = 0; q < S; q++) {
+        float a_re = x[2 * q], a_im = x[2 * q + 1];
+        float b_re = x[2 * (q + S)], b_im = x[2 * (q + S) + 1];
+        y[2 * q] = a_re + b_re;
+        y[2 * q + 1] = a_im + b_im;
+        y[2 * (q + S)] = a_re - b_re;
+        y[2 * (q + S) + 1] = a_im - b_im;
+    }
+}
+
+// Stages from stride S on: `in` holds the sub-transforms and `other` is the
+// free buffer; the last stage writes into `data`, in place if in == data
+template <size_t N, size_t S>
+inline void fft_stages(float* in, float* other, float* data) {
+    constexpr size_t n = N / S;
+    if constexpr (n == 2) {
+        radix2_stage<S>(in, data);
+    } else {
+        constexpr size_t m = n / 4;
+        const float* tw = FftTables<N>::twiddles.data() + 2 * twiddle_offset(N, S);
+        if constexpr (m == 1) {
+            radix4_stage<1, S>(in, data, tw);
+        } else {
+            radix4_stage<m, S>(in, other, tw);
+            fft_stages<N, 4 * S>(other, in, data);
+        }
+    }
+}
+
+template <size_t N>
+void fixed_fft(fftwf_complex* x, fftwf_complex* work) {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "FIXED_FFT_LENGTHS must be powers of two");
+    float* data = reinterpret_cast<float*>(x);
+    fft_stages<N, 1>(data, reinterpret_cast<float*>(work), data);
+}
+
+struct FixedEntry {
+    size_t length;
+    FixedFft fft;
+};
+
+template <size_t... Ns>
+constexpr std::array<FixedEntry, sizeof...(Ns)> make_table() {
+    return {{FixedEntry{Ns, &fixed_fft<Ns>}...}};
+}
+
+constexpr auto FIXED_TABLE = make_table<FIXED_FFT_LENGTHS>();
+
+} // namespace
+
+FixedFft find_fixed_fft(size_t length) {
+    for (size_t i = 0; i < FIXED_TABLE.size(); i++) {
+        if (FIXED_TABLE[i].length == length) {
+            return FIXED_TABLE[i].fft;
+        }
+    }
+    return NULL;
+}
+
+} // namespace BATCH_FFT_ISA
@@ -0,0 +1,179 @@
+#include "four_step.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+bool four_step_split(size_t length, size_t& rows, size_t& cols) {
+    const size_t b = FOUR_STEP_BLOCK;
+    rows = 0;
+    cols = 0;
+    for (size_t n1 = b; n1 * n1 <= length; n1 += b) {
+        if (length % n1 == 0 && (length / n1) % b == 0) {
+            rows = n1;
+            cols = length / n1;
+        }
+    }
+    return rows > 0;
+}
+
+// W_N^e from the two small tables, rounded to float once
+static void seed_twiddle(const FourStepBatch& fs, size_t e, fftwf_complex& w) {
+    e %= fs.length;
+    const double* c = &fs.coarse[2 * (e / fs.fine_size)];
+    const double* f = &fs.fine[2 * (e % fs.fine_size)];
+    w[0] = static_cast<float>(c[0] * f[0] - c[1] * f[1]);
+    w[1] = static_cast<float>(c[0] * f[1] + c[1] * f[0]);
+}
+
+static void fill_turns(std::vector<double>& w, size_t count, size_t step, size_t n) {
+    w.resize(2 * count);
+    for (size_t i = 0; i < count; i++) {
+        double angle = -2.0 * M_PI * static_cast<double>((i * step) % n) / static_cast<double>(n);
+        w[2 * i] = std::cos(angle);
+        w[2 * i + 1] = std::sin(angle);
+    }
+}
+
+// FOUR_STEP_BLOCK transforms of n points, `stride` apart within a
+// transform and `dist` apart from each other
+static fftwf_plan plan_block(size_t n, fftwf_complex* in, int in_stride, int in_dist,
+                             fftwf_complex* out, int out_stride, int out_dist) {
+    int dims[] = {static_cast<int>(n)};
+    return fftwf_plan_many_dft(
+        1, dims, static_cast<int>(FOUR_STEP_BLOCK),
+        in, NULL, in_stride, in_dist,
+        out, NULL, out_stride, out_dist,
+        FFTW_FORWARD, FFTW_MEASURE);
+}
+
+bool create_four_step(FourStepBatch& fs, size_t batch, size_t length, int threads, bool table) {
+    fs.batch = batch;
+    fs.length = length;
+    fs.workers = std::min<size_t>(static_cast<size_t>(threads), batch);
+    fs.table = NULL;
+    fs.column_plan = NULL;
+    fs.row_plan = NULL;
+    if (!four_step_split(length, fs.rows, fs.cols)) {
+        return false;
+    }
+
+    const size_t b = FOUR_STEP_BLOCK;
+    for (size_t i = 0; i < fs.workers; i++) {
+        fs.tiles.push_back(fftwf_alloc_complex(b * fs.rows));
+        fs.tiles.push_back(fftwf_alloc_complex(b * fs.cols));
+        fs.tiles.push_back(fftwf_alloc_complex(length));
+    }
+
+    fs.fine_size = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(length))));
+    fill_turns(fs.fine, fs.fine_size, 1, length);
+    fill_turns(fs.coarse, (length + fs.fine_size - 1) / fs.fine_size, fs.fine_size, length);
+
+    if (table) {
+        fs.table = fftwf_alloc_complex(length);
+        for (size_t k1 = 0; k1 < fs.rows; k1++) {
+            for (size_t n2 = 0; n2 < fs.cols; n2++) {
+                double angle = -2.0 * M_PI * static_cast<double>((n2 * k1) % length) /
+                               static_cast<double>(length);
+                fs.table[k1 * fs.cols + n2][0] = static_cast<float>(std::cos(angle));
+                fs.table[k1 * fs.cols + n2][1] = static_cast<float>(std::sin(angle));
+            }
+        }
+    }
+
+    // Single-threaded block plans, the workers run them in parallel
+    fftwf_plan_with_nthreads(1);
+    const int block = static_cast<int>(b);
+    fs.column_plan = plan_block(fs.rows, fs.tiles[0], block, 1, fs.tiles[0], block, 1);
+    fs.row_plan = plan_block(fs.cols, fs.tiles[2], 1, static_cast<int>(fs.cols), fs.tiles[1], 1,
+                             static_cast<int>(fs.cols));
+    fftwf_plan_with_nthreads(threads);
+    return fs.column_plan != NULL && fs.row_plan != NULL;
+}
+
+void destroy_four_step(FourStepBatch& fs) {
+    if (fs.column_plan != NULL) {
+        fftwf_destroy_plan(fs.column_plan);
+    }
+    if (fs.row_plan != NULL) {
+        fftwf_destroy_plan(fs.row_plan);
+    }
+    for (size_t i = 0; i < fs.tiles.size(); i++) {
+        fftwf_free(fs.tiles[i]);
+    }
+    fs.tiles.clear();
+    fftwf_free(fs.table);
+    fs.table = NULL;
+}
+
+// One signal in place: column pass into `work`, row pass back into x. The
+// column tile keeps its block interleaved (FOUR_STEP_BLOCK values per row),
+// so the gather and the twiddle pass move whole runs of samples; the
+// strided rows are prefetched since every run starts a new page.
+static void four_step_signal(const FourStepBatch& fs, fftwf_complex* x, fftwf_complex* column_tile,
+                             fftwf_complex* row_tile, fftwf_complex* work) {
+    const size_t b = FOUR_STEP_BLOCK;
+    const size_t n1 = fs.rows;
+    const size_t n2 = fs.cols;
+    fftwf_complex t[FOUR_STEP_BLOCK];
+    fftwf_complex step[FOUR_STEP_BLOCK];
+
+    // Columns c0..c0 + b: column_tile[n1·b + c] = x[N2·n1 + c0 + c], FFTs
+    // down the tile, then work[k1·N2 + n2] = W_N^(n2·k1) · column_tile[k1·b + c]
+    for (size_t c0 = 0; c0 < n2; c0 += b) {
+        for (size_t r = 0; r < n1; r++) {
+            const fftwf_complex* ahead = x + std::min(r + FOUR_STEP_PREFETCH, n1 - 1) * n2 + c0;
+            for (size_t i = 0; i < b; i += 8) {
+                __builtin_prefetch(ahead + i);
+            }
+            memcpy(column_tile + r * b, x + r * n2 + c0, b * sizeof(fftwf_complex));
+        }
+        fftwf_execute_dft(fs.column_plan, column_tile, column_tile);
+        if (fs.table != NULL) {
+            for (size_t r = 0; r < n1; r++) {
+                multiply_complex(column_tile + r * b, fs.table + r * n2 + c0, work + r * n2 + c0, b);
+            }
+            continue;
+        }
+        for (size_t c = 0; c < b; c++) {
+            seed_twiddle(fs, c0 + c, step[c]);
+        }
+        for (size_t r0 = 0; r0 < n1; r0 += FOUR_STEP_RESEED) {
+            for (size_t c = 0; c < b; c++) {
+                seed_twiddle(fs, (c0 + c) * r0, t[c]);
+            }
+            twiddle_rows(column_tile + r0 * b, std::min(FOUR_STEP_RESEED, n1 - r0), b, b,
+                         work + r0 * n2 + c0, n2, t, step);
+        }
+    }
+
+    // Rows r0..r0 + b: row_tile[r·N2 + k2] = FFT of work[(r0 + r)·N2 + n2],
+    // transposed to x[k1 + N1·k2]
+    for (size_t r0 = 0; r0 < n1; r0 += b) {
+        fftwf_execute_dft(fs.row_plan, work + r0 * n2, row_tile);
+        transpose(row_tile, b, n2, n2, x + r0, n1, 0);
+    }
+}
+
+static void four_step_worker(const FourStepBatch& fs, fftwf_complex* data, size_t id) {
+    fftwf_complex* column_tile = fs.tiles[3 * id];
+    fftwf_complex* row_tile = fs.tiles[3 * id + 1];
+    fftwf_complex* work = fs.tiles[3 * id + 2];
+    for (size_t s = id; s < fs.batch; s += fs.workers) {
+        four_step_signal(fs, data + s * fs.length, column_tile, row_tile, work);
+    }
+}
+
+void execute_four_step(const FourStepBatch& fs, fftwf_complex* data) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < fs.workers; id++) {
+        pool.push_back(std::thread(four_step_worker, std::cref(fs), data, id));
+    }
+    four_step_worker(fs, data, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
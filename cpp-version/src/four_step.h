@@ -0,0 +1,57 @@
+#ifndef BATCH_FFT_FOUR_STEP_H
+#define BATCH_FFT_FOUR_STEP_H
+
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+// Cache-blocked four-step FFT for long signals. With N = N1 × N2, n = N2·n1 + n2
+// and k = k1 + N1·k2,
+//   X[k1 + N1·k2] = Σ_n2 W_N2^(n2·k2) · W_N^(n2·k1) · Σ_n1 W_N1^(n1·k1) x[N2·n1 + n2]
+// Each signal takes two passes over memory. First, FOUR_STEP_BLOCK columns n2
+// at a time are gathered into a tile, transformed over n1, multiplied by the
+// twiddles W_N^(n2·k1) and written to rows k1 of a work array. Second,
+// FOUR_STEP_BLOCK rows k1 at a time are transformed over n2 and transposed
+// into place. The sub-transforms are single-threaded fftwf_plan_many_dft
+// plans over one block, so only a block and its plan are live in cache.
+//
+// The N inter-stage twiddles come from a full table (8N bytes, 4 MB at
+// 512K points, streamed through the caches next to the data) or, without
+// it, from a recurrence t ← t·W_N^n2 per column that is reseeded exactly
+// every FOUR_STEP_RESEED rows from two tables of about √N entries each,
+// W_N^e = coarse[e / S]·fine[e % S] in double.
+
+const size_t FOUR_STEP_BLOCK = 64;
+const size_t FOUR_STEP_RESEED = 16;
+const size_t FOUR_STEP_PREFETCH = 8;     // rows ahead in the column gather
+
+struct FourStepBatch {
+    size_t batch;
+    size_t length;
+    size_t rows;            // N1: length of the column transforms
+    size_t cols;            // N2: length of the row transforms
+    size_t workers;         // signals id, id + workers, ... per worker
+    size_t fine_size;       // S
+    std::vector<double> coarse;     // W_N^(q·S), re/im interleaved
+    std::vector<double> fine;       // W_N^r, r < S
+    fftwf_complex* table;   // W_N^(n2·k1) at k1·N2 + n2, NULL to use the recurrence
+    std::vector<fftwf_complex*> tiles;  // per worker: column tile, row tile, work array
+    fftwf_plan column_plan; // N1-point, FOUR_STEP_BLOCK interleaved columns of a tile, in place
+    fftwf_plan row_plan;    // N2-point, FOUR_STEP_BLOCK rows of the work array into a tile, interleaved
+};
+
+// Split `length` into N1 × N2 with N1 <= N2 as close to √length as
+// possible, both multiples of FOUR_STEP_BLOCK. False if there is no such split.
+bool four_step_split(size_t length, size_t& rows, size_t& cols);
+
+// Plan `batch` signals of `length` samples; `table` selects the full
+// twiddle table. False if the length has no split or FFTW could not create
+// a plan; destroy_four_step must still be called.
+bool create_four_step(FourStepBatch& fs, size_t batch, size_t length, int threads, bool table);
+
+// Transform `batch` contiguous signals in place
+void execute_four_step(const FourStepBatch& fs, fftwf_complex* data);
+
+void destroy_four_step(FourStepBatch& fs);
+
+#endif // BATCH_FFT_FOUR_STEP_H
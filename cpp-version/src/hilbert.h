@@ -0,0 +1,19 @@
+#ifndef BATCH_FFT_HILBERT_H
+#define BATCH_FFT_HILBERT_H
+
+#include "common.h"
+
+// Analytic signal z = x + i·H{x} of `batch` real signals of `length`
+// samples: forward real-input FFT, negative frequencies zeroed, positive
+// ones doubled (DC and Nyquist kept), inverse complex FFT. --envelope
+// returns only |z|, the signal envelope.
+//
+// --method fused (default) runs all three steps per tile of signals that
+// fits in L2: the mask and the 1/N scale are applied to the tile's spectra
+// while they are in cache, and the inverse writes straight into the output.
+// --method separate makes three passes over the whole batch (forward, mask,
+// inverse, plus the magnitude pass for --envelope); each method is timed
+// against the other.
+int run_hilbert(const Args& args);
+
+#endif // BATCH_FFT_HILBERT_H
@@ -0,0 +1,1041 @@
+#include "kernels.h"
+#include "dispatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace BATCH_FFT_ISA {
+
+void apply_window(const fftwf_complex* in, const float* w, fftwf_complex* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i][0] = in[i][0] * w[i];
+        out[i][1] = in[i][1] * w[i];
+    }
+}
+
+void accumulate_power(const fftwf_complex* x, float* sum, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        sum[i] += x[i][0] * x[i][0] + x[i][1] * x[i][1];
+    }
+}
+
+void multiply_complex(const fftwf_complex* x, const fftwf_complex* h, fftwf_complex* y, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    const float* hf = reinterpret_cast<const float*>(h);
+    float* yf = reinterpret_cast<float*>(y);
+    size_t i = 0;
+
+    // (a + ib)(c + id): [a b]*[c c] -/+ [b a]*[d d] = [ac - bd, bc + ad]
+#if defined(__AVX__)
+    for (; i + 4 <= n; i += 4) {
+        __m256 a = _mm256_loadu_ps(xf + 2 * i);
+        __m256 b = _mm256_loadu_ps(hf + 2 * i);
+        __m256 b_re = _mm256_moveldup_ps(b);
+        __m256 b_im = _mm256_movehdup_ps(b);
+        __m256 a_swap = _mm256_permute_ps(a, 0xB1);
+#if defined(__FMA__)
+        __m256 r = _mm256_fmaddsub_ps(a, b_re, _mm256_mul_ps(a_swap, b_im));
+#else
+        __m256 r = _mm256_addsub_ps(_mm256_mul_ps(a, b_re), _mm256_mul_ps(a_swap, b_im));
+#endif
+        _mm256_storeu_ps(yf + 2 * i, r);
+    }
+#elif defined(__SSE3__)
+    for (; i + 2 <= n; i += 2) {
+        __m128 a = _mm_loadu_ps(xf + 2 * i);
+        __m128 b = _mm_loadu_ps(hf + 2 * i);
+        __m128 b_re = _mm_moveldup_ps(b);
+        __m128 b_im = _mm_movehdup_ps(b);
+        __m128 a_swap = _mm_shuffle_ps(a, a, 0xB1);
+        _mm_storeu_ps(yf + 2 * i, _mm_addsub_ps(_mm_mul_ps(a, b_re), _mm_mul_ps(a_swap, b_im)));
+    }
+#endif
+    for (; i < n; i++) {
+        float a = xf[2 * i], b = xf[2 * i + 1];
+        float c = hf[2 * i], d = hf[2 * i + 1];
+        yf[2 * i] = a * c - b * d;
+        yf[2 * i + 1] = b * c + a * d;
+    }
+}
+
+void multiply_spectrum(fftwf_complex* x, const fftwf_complex* h, size_t n) {
+    multiply_complex(x, h, x, n);
+}
+
+void multiply_conj_spectrum(fftwf_complex* x, const fftwf_complex* y, size_t n, float scale) {
+    float* xf = reinterpret_cast<float*>(x);
+    const float* yf = reinterpret_cast<const float*>(y);
+    size_t i = 0;
+
+    // (a + ib)(c - id): [a b]*[c c] +/- [b a]*[d d] = [ac + bd, bc - ad]
+#if defined(__AVX__)
+    const __m256 s = _mm256_set1_ps(scale);
+    for (; i + 4 <= n; i += 4) {
+        __m256 a = _mm256_loadu_ps(xf + 2 * i);
+        __m256 b = _mm256_loadu_ps(yf + 2 * i);
+        __m256 b_re = _mm256_moveldup_ps(b);
+        __m256 b_im = _mm256_movehdup_ps(b);
+        __m256 a_swap = _mm256_permute_ps(a, 0xB1);
+#if defined(__FMA__)
+        __m256 r = _mm256_fmsubadd_ps(a, b_re, _mm256_mul_ps(a_swap, b_im));
+#else
+        const __m256 odd_sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+        __m256 r = _mm256_add_ps(_mm256_mul_ps(a, b_re),
+                                 _mm256_xor_ps(_mm256_mul_ps(a_swap, b_im), odd_sign));
+#endif
+        _mm256_storeu_ps(xf + 2 * i, _mm256_mul_ps(r, s));
+    }
+#elif defined(__SSE3__)
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 odd_sign = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    for (; i + 2 <= n; i += 2) {
+        __m128 a = _mm_loadu_ps(xf + 2 * i);
+        __m128 b = _mm_loadu_ps(yf + 2 * i);
+        __m128 b_re = _mm_moveldup_ps(b);
+        __m128 b_im = _mm_movehdup_ps(b);
+        __m128 a_swap = _mm_shuffle_ps(a, a, 0xB1);
+        __m128 r = _mm_add_ps(_mm_mul_ps(a, b_re), _mm_xor_ps(_mm_mul_ps(a_swap, b_im), odd_sign));
+        _mm_storeu_ps(xf + 2 * i, _mm_mul_ps(r, s));
+    }
+#endif
+    for (; i < n; i++) {
+        float a = xf[2 * i], b = xf[2 * i + 1];
+        float c = yf[2 * i], d = yf[2 * i + 1];
+        xf[2 * i] = (a * c + b * d) * scale;
+        xf[2 * i + 1] = (b * c - a * d) * scale;
+    }
+}
+
+void complex_dot(const fftwf_complex* a, const fftwf_complex* b, size_t n, fftwf_complex* result) {
+    const float* af = reinterpret_cast<const float*>(a);
+    const float* bf = reinterpret_cast<const float*>(b);
+    float re = 0.0f;
+    float im = 0.0f;
+    size_t i = 0;
+
+    // Sum a*re(b) and swap(a)*im(b) separately; one addsub at the end gives
+    // [Σ ac - bd, Σ bc + ad]
+#if defined(__AVX__)
+    __m256 acc_re = _mm256_setzero_ps();
+    __m256 acc_im = _mm256_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m256 x = _mm256_loadu_ps(af + 2 * i);
+        __m256 y = _mm256_loadu_ps(bf + 2 * i);
+        __m256 x_swap = _mm256_permute_ps(x, 0xB1);
+#if defined(__FMA__)
+        acc_re = _mm256_fmadd_ps(x, _mm256_moveldup_ps(y), acc_re);
+        acc_im = _mm256_fmadd_ps(x_swap, _mm256_movehdup_ps(y), acc_im);
+#else
+        acc_re = _mm256_add_ps(acc_re, _mm256_mul_ps(x, _mm256_moveldup_ps(y)));
+        acc_im = _mm256_add_ps(acc_im, _mm256_mul_ps(x_swap, _mm256_movehdup_ps(y)));
+#endif
+    }
+    __m256 sum8 = _mm256_addsub_ps(acc_re, acc_im);
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+    __m128 sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    re = _mm_cvtss_f32(sum2);
+    im = _mm_cvtss_f32(_mm_shuffle_ps(sum2, sum2, 1));
+#elif defined(__SSE3__)
+    __m128 acc_re = _mm_setzero_ps();
+    __m128 acc_im = _mm_setzero_ps();
+    for (; i + 2 <= n; i += 2) {
+        __m128 x = _mm_loadu_ps(af + 2 * i);
+        __m128 y = _mm_loadu_ps(bf + 2 * i);
+        __m128 x_swap = _mm_shuffle_ps(x, x, 0xB1);
+        acc_re = _mm_add_ps(acc_re, _mm_mul_ps(x, _mm_moveldup_ps(y)));
+        acc_im = _mm_add_ps(acc_im, _mm_mul_ps(x_swap, _mm_movehdup_ps(y)));
+    }
+    __m128 sum4 = _mm_addsub_ps(acc_re, acc_im);
+    __m128 sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    re = _mm_cvtss_f32(sum2);
+    im = _mm_cvtss_f32(_mm_shuffle_ps(sum2, sum2, 1));
+#endif
+    for (; i < n; i++) {
+        re += af[2 * i] * bf[2 * i] - af[2 * i + 1] * bf[2 * i + 1];
+        im += af[2 * i] * bf[2 * i + 1] + af[2 * i + 1] * bf[2 * i];
+    }
+    (*result)[0] = re;
+    (*result)[1] = im;
+}
+
+#if defined(__AVX__)
+// Bins [b, b + 8) of S signals, with all 4·S recurrences kept in registers
+template <int S>
+static void goertzel_avx(const float* x, size_t stride, size_t n, const float* coeffs,
+                         size_t b, size_t bins, float* state) {
+    const __m256 c = _mm256_loadu_ps(coeffs + b);
+    __m256 s1r[S], s2r[S], s1i[S], s2i[S];
+    for (int s = 0; s < S; s++) {
+        const float* st = state + 4 * s * bins + b;
+        s1r[s] = _mm256_loadu_ps(st);
+        s2r[s] = _mm256_loadu_ps(st + bins);
+        s1i[s] = _mm256_loadu_ps(st + 2 * bins);
+        s2i[s] = _mm256_loadu_ps(st + 3 * bins);
+    }
+    // Two samples per iteration, so s1 and s2 swap roles instead of moving
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        for (int s = 0; s < S; s++) {
+            const float* xs = x + 2 * (s * stride + i);
+            __m256 r0 = _mm256_sub_ps(_mm256_broadcast_ss(xs), s2r[s]);
+            __m256 m0 = _mm256_sub_ps(_mm256_broadcast_ss(xs + 1), s2i[s]);
+#if defined(__FMA__)
+            s2r[s] = _mm256_fmadd_ps(c, s1r[s], r0);
+            s2i[s] = _mm256_fmadd_ps(c, s1i[s], m0);
+            __m256 r1 = _mm256_sub_ps(_mm256_broadcast_ss(xs + 2), s1r[s]);
+            __m256 m1 = _mm256_sub_ps(_mm256_broadcast_ss(xs + 3), s1i[s]);
+            s1r[s] = _mm256_fmadd_ps(c, s2r[s], r1);
+            s1i[s] = _mm256_fmadd_ps(c, s2i[s], m1);
+#else
+            s2r[s] = _mm256_add_ps(_mm256_mul_ps(c, s1r[s]), r0);
+            s2i[s] = _mm256_add_ps(_mm256_mul_ps(c, s1i[s]), m0);
+            __m256 r1 = _mm256_sub_ps(_mm256_broadcast_ss(xs + 2), s1r[s]);
+            __m256 m1 = _mm256_sub_ps(_mm256_broadcast_ss(xs + 3), s1i[s]);
+            s1r[s] = _mm256_add_ps(_mm256_mul_ps(c, s2r[s]), r1);
+            s1i[s] = _mm256_add_ps(_mm256_mul_ps(c, s2i[s]), m1);
+#endif
+        }
+    }
+    for (; i < n; i++) {
+        for (int s = 0; s < S; s++) {
+            const float* xs = x + 2 * (s * stride + i);
+            __m256 r = _mm256_sub_ps(_mm256_broadcast_ss(xs), s2r[s]);
+            __m256 m = _mm256_sub_ps(_mm256_broadcast_ss(xs + 1), s2i[s]);
+            s2r[s] = s1r[s];
+            s2i[s] = s1i[s];
+            s1r[s] = _mm256_add_ps(_mm256_mul_ps(c, s1r[s]), r);
+            s1i[s] = _mm256_add_ps(_mm256_mul_ps(c, s1i[s]), m);
+        }
+    }
+    for (int s = 0; s < S; s++) {
+        float* st = state + 4 * s * bins + b;
+        _mm256_storeu_ps(st, s1r[s]);
+        _mm256_storeu_ps(st + bins, s2r[s]);
+        _mm256_storeu_ps(st + 2 * bins, s1i[s]);
+        _mm256_storeu_ps(st + 3 * bins, s2i[s]);
+    }
+}
+#elif defined(__SSE3__)
+// Bins [b, b + 4) of S signals, with all 4·S recurrences kept in registers
+template <int S>
+static void goertzel_sse(const float* x, size_t stride, size_t n, const float* coeffs,
+                         size_t b, size_t bins, float* state) {
+    const __m128 c = _mm_loadu_ps(coeffs + b);
+    __m128 s1r[S], s2r[S], s1i[S], s2i[S];
+    for (int s = 0; s < S; s++) {
+        const float* st = state + 4 * s * bins + b;
+        s1r[s] = _mm_loadu_ps(st);
+        s2r[s] = _mm_loadu_ps(st + bins);
+        s1i[s] = _mm_loadu_ps(st + 2 * bins);
+        s2i[s] = _mm_loadu_ps(st + 3 * bins);
+    }
+    // Two samples per iteration, so s1 and s2 swap roles instead of moving
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        for (int s = 0; s < S; s++) {
+            const float* xs = x + 2 * (s * stride + i);
+            s2r[s] = _mm_add_ps(_mm_mul_ps(c, s1r[s]), _mm_sub_ps(_mm_set1_ps(xs[0]), s2r[s]));
+            s2i[s] = _mm_add_ps(_mm_mul_ps(c, s1i[s]), _mm_sub_ps(_mm_set1_ps(xs[1]), s2i[s]));
+            s1r[s] = _mm_add_ps(_mm_mul_ps(c, s2r[s]), _mm_sub_ps(_mm_set1_ps(xs[2]), s1r[s]));
+            s1i[s] = _mm_add_ps(_mm_mul_ps(c, s2i[s]), _mm_sub_ps(_mm_set1_ps(xs[3]), s1i[s]));
+        }
+    }
+    for (; i < n; i++) {
+        for (int s = 0; s < S; s++) {
+            const float* xs = x + 2 * (s * stride + i);
+            __m128 r = _mm_sub_ps(_mm_set1_ps(xs[0]), s2r[s]);
+            __m128 m = _mm_sub_ps(_mm_set1_ps(xs[1]), s2i[s]);
+            s2r[s] = s1r[s];
+            s2i[s] = s1i[s];
+            s1r[s] = _mm_add_ps(_mm_mul_ps(c, s1r[s]), r);
+            s1i[s] = _mm_add_ps(_mm_mul_ps(c, s1i[s]), m);
+        }
+    }
+    for (int s = 0; s < S; s++) {
+        float* st = state + 4 * s * bins + b;
+        _mm_storeu_ps(st, s1r[s]);
+        _mm_storeu_ps(st + bins, s2r[s]);
+        _mm_storeu_ps(st + 2 * bins, s1i[s]);
+        _mm_storeu_ps(st + 3 * bins, s2i[s]);
+    }
+}
+#endif
+
+void goertzel_update(const fftwf_complex* x, size_t stride, size_t signals, size_t n,
+                     const float* coeffs, size_t bins, float* state) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    size_t b = 0;
+
+    // Lanes are bins; two signals share each coefficient load and give four
+    // independent dependency chains per group of bins
+#if defined(__AVX__)
+    for (; b + 8 <= bins; b += 8) {
+        size_t s = 0;
+        for (; s + 2 <= signals; s += 2) {
+            goertzel_avx<2>(xf + 2 * s * stride, stride, n, coeffs, b, bins, state + 4 * s * bins);
+        }
+        if (s < signals) {
+            goertzel_avx<1>(xf + 2 * s * stride, stride, n, coeffs, b, bins, state + 4 * s * bins);
+        }
+    }
+#elif defined(__SSE3__)
+    for (; b + 4 <= bins; b += 4) {
+        size_t s = 0;
+        for (; s + 2 <= signals; s += 2) {
+            goertzel_sse<2>(xf + 2 * s * stride, stride, n, coeffs, b, bins, state + 4 * s * bins);
+        }
+        if (s < signals) {
+            goertzel_sse<1>(xf + 2 * s * stride, stride, n, coeffs, b, bins, state + 4 * s * bins);
+        }
+    }
+#endif
+    for (size_t s = 0; s < signals; s++) {
+        float* st = state + 4 * s * bins;
+        for (size_t k = b; k < bins; k++) {
+            float s1r = st[k], s2r = st[bins + k], s1i = st[2 * bins + k], s2i = st[3 * bins + k];
+            for (size_t i = 0; i < n; i++) {
+                float r = xf[2 * (s * stride + i)] + coeffs[k] * s1r - s2r;
+                float m = xf[2 * (s * stride + i) + 1] + coeffs[k] * s1i - s2i;
+                s2r = s1r;
+                s1r = r;
+                s2i = s1i;
+                s1i = m;
+            }
+            st[k] = s1r;
+            st[bins + k] = s2r;
+            st[2 * bins + k] = s1i;
+            st[3 * bins + k] = s2i;
+        }
+    }
+}
+
+size_t max_power_index(const fftwf_complex* x, size_t begin, size_t end) {
+    size_t best = begin;
+    float best_power = -1.0f;
+    for (size_t i = begin; i < end; i++) {
+        float power = x[i][0] * x[i][0] + x[i][1] * x[i][1];
+        if (power > best_power) {
+            best_power = power;
+            best = i;
+        }
+    }
+    return best;
+}
+
+#if defined(__AVX__)
+// Rows r..r + 3 by columns c..c + 3: each complex sample is one double lane,
+// so this is the 4 × 4 double transpose of unpacks and 128-bit permutes
+static inline void transpose_4x4(const fftwf_complex* in, size_t in_stride, fftwf_complex* out,
+                                 size_t out_stride) {
+    __m256d a = _mm256_loadu_pd(reinterpret_cast<const double*>(in));
+    __m256d b = _mm256_loadu_pd(reinterpret_cast<const double*>(in + in_stride));
+    __m256d c = _mm256_loadu_pd(reinterpret_cast<const double*>(in + 2 * in_stride));
+    __m256d d = _mm256_loadu_pd(reinterpret_cast<const double*>(in + 3 * in_stride));
+    __m256d ab_even = _mm256_unpacklo_pd(a, b);
+    __m256d ab_odd = _mm256_unpackhi_pd(a, b);
+    __m256d cd_even = _mm256_unpacklo_pd(c, d);
+    __m256d cd_odd = _mm256_unpackhi_pd(c, d);
+    _mm256_storeu_pd(reinterpret_cast<double*>(out), _mm256_permute2f128_pd(ab_even, cd_even, 0x20));
+    _mm256_storeu_pd(reinterpret_cast<double*>(out + out_stride), _mm256_permute2f128_pd(ab_odd, cd_odd, 0x20));
+    _mm256_storeu_pd(reinterpret_cast<double*>(out + 2 * out_stride),
+                     _mm256_permute2f128_pd(ab_even, cd_even, 0x31));
+    _mm256_storeu_pd(reinterpret_cast<double*>(out + 3 * out_stride),
+                     _mm256_permute2f128_pd(ab_odd, cd_odd, 0x31));
+}
+#endif
+
+void transpose(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+               fftwf_complex* out, size_t out_stride, size_t prefetch) {
+    // Blocks of 16 rows by 8 columns: one input line per row, two output
+    // lines per column, written whole before the next column
+    const size_t block_rows = 16;
+    const size_t block_cols = 8;
+    const size_t col_blocks = (cols + block_cols - 1) / block_cols;
+    const size_t blocks = (rows + block_rows - 1) / block_rows * col_blocks;
+    for (size_t k = 0; k < blocks; k++) {
+        size_t r0 = k / col_blocks * block_rows;
+        size_t c0 = k % col_blocks * block_cols;
+        size_t r1 = std::min(rows, r0 + block_rows);
+        size_t c1 = std::min(cols, c0 + block_cols);
+
+        // Input lines of the block `prefetch` blocks further on
+        if (prefetch > 0 && k + prefetch < blocks) {
+            size_t pr0 = (k + prefetch) / col_blocks * block_rows;
+            size_t pc0 = (k + prefetch) % col_blocks * block_cols;
+            size_t pr1 = std::min(rows, pr0 + block_rows);
+            size_t pc1 = std::min(cols, pc0 + block_cols);
+            for (size_t r = pr0; r < pr1; r++) {
+                __builtin_prefetch(in + r * in_stride + pc0);
+                __builtin_prefetch(in + r * in_stride + pc1 - 1);
+            }
+        }
+
+        size_t c = c0;
+#if defined(__AVX__)
+        if (r1 - r0 == block_rows) {
+            for (; c + 4 <= c1; c += 4) {
+                for (size_t r = r0; r < r1; r += 4) {
+                    transpose_4x4(in + r * in_stride + c, in_stride, out + c * out_stride + r, out_stride);
+                }
+            }
+        }
+#endif
+        for (; c < c1; c++) {
+            for (size_t r = r0; r < r1; r++) {
+                out[c * out_stride + r][0] = in[r * in_stride + c][0];
+                out[c * out_stride + r][1] = in[r * in_stride + c][1];
+            }
+        }
+    }
+}
+
+#if defined(__AVX__)
+// Four complex products at once, [ac - bd, bc + ad]
+static inline __m256 complex_mul_avx(__m256 a, __m256 b) {
+    __m256 b_re = _mm256_moveldup_ps(b);
+    __m256 b_im = _mm256_movehdup_ps(b);
+    __m256 a_swap = _mm256_permute_ps(a, 0xB1);
+#if defined(__FMA__)
+    return _mm256_fmaddsub_ps(a, b_re, _mm256_mul_ps(a_swap, b_im));
+#else
+    return _mm256_addsub_ps(_mm256_mul_ps(a, b_re), _mm256_mul_ps(a_swap, b_im));
+#endif
+}
+#endif
+
+void twiddle_rows(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+                  fftwf_complex* out, size_t out_stride, fftwf_complex* t, const fftwf_complex* step) {
+    size_t c = 0;
+
+    // Four columns per register; the twiddles advance one step per row
+#if defined(__AVX__)
+    for (; c + 4 <= cols; c += 4) {
+        __m256 tw = _mm256_loadu_ps(&t[c][0]);
+        const __m256 st = _mm256_loadu_ps(&step[c][0]);
+        for (size_t r = 0; r < rows; r++) {
+            __m256 x = _mm256_loadu_ps(&in[r * in_stride + c][0]);
+            _mm256_storeu_ps(&out[r * out_stride + c][0], complex_mul_avx(x, tw));
+            tw = complex_mul_avx(tw, st);
+        }
+        _mm256_storeu_ps(&t[c][0], tw);
+    }
+#endif
+    for (; c < cols; c++) {
+        float re = t[c][0];
+        float im = t[c][1];
+        for (size_t r = 0; r < rows; r++) {
+            const fftwf_complex& x = in[r * in_stride + c];
+            out[r * out_stride + c][0] = x[0] * re - x[1] * im;
+            out[r * out_stride + c][1] = x[0] * im + x[1] * re;
+            float next = re * step[c][0] - im * step[c][1];
+            im = re * step[c][1] + im * step[c][0];
+            re = next;
+        }
+        t[c][0] = re;
+        t[c][1] = im;
+    }
+}
+
+void polyphase_fir(const fftwf_complex* x, const float* h2, size_t taps, size_t channels,
+                   fftwf_complex* y) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    float* yf = reinterpret_cast<float*>(y);
+    const size_t row = 2 * channels;   // floats per branch
+    size_t k = 0;
+
+    // Accumulate all taps of 4 (AVX) or 2 (SSE) channels in a register
+#if defined(__AVX__)
+    for (; k + 8 <= row; k += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t p = 0; p < taps; p++) {
+            __m256 xv = _mm256_loadu_ps(xf + p * row + k);
+            __m256 hv = _mm256_loadu_ps(h2 + p * row + k);
+#if defined(__FMA__)
+            acc = _mm256_fmadd_ps(hv, xv, acc);
+#else
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(hv, xv));
+#endif
+        }
+        _mm256_storeu_ps(yf + k, acc);
+    }
+#elif defined(__SSE3__)
+    for (; k + 4 <= row; k += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (size_t p = 0; p < taps; p++) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(h2 + p * row + k),
+                                             _mm_loadu_ps(xf + p * row + k)));
+        }
+        _mm_storeu_ps(yf + k, acc);
+    }
+#endif
+    for (; k < row; k++) {
+        float acc = 0.0f;
+        for (size_t p = 0; p < taps; p++) {
+            acc += h2[p * row + k] * xf[p * row + k];
+        }
+        yf[k] = acc;
+    }
+}
+
+#if defined(__AVX__)
+// Bins [k, k + 4) of M pairs, with the 2·M sums held in registers over all
+// rows. For a = p + iq and x = u + iv the lanes gather [pu pv] and [qu qv];
+// a * conj(x) = [pu -pv] + swap([qu qv]) is formed once at the end
+template <int M>
+static void cross_avx(const float* a, const float* b, size_t rows, size_t stride, size_t dist,
+                      size_t k, float* sum) {
+    __m256 acc_re[M], acc_im[M];
+    for (int m = 0; m < M; m++) {
+        acc_re[m] = _mm256_setzero_ps();
+        acc_im[m] = _mm256_setzero_ps();
+    }
+    for (size_t r = 0; r < rows; r++) {
+        __m256 va = _mm256_loadu_ps(a + 2 * (r * stride + k));
+        __m256 re = _mm256_moveldup_ps(va);
+        __m256 im = _mm256_movehdup_ps(va);
+        for (int m = 0; m < M; m++) {
+            __m256 vb = _mm256_loadu_ps(b + 2 * (r * stride + m * dist + k));
+#if defined(__FMA__)
+            acc_re[m] = _mm256_fmadd_ps(re, vb, acc_re[m]);
+            acc_im[m] = _mm256_fmadd_ps(im, vb, acc_im[m]);
+#else
+            acc_re[m] = _mm256_add_ps(acc_re[m], _mm256_mul_ps(re, vb));
+            acc_im[m] = _mm256_add_ps(acc_im[m], _mm256_mul_ps(im, vb));
+#endif
+        }
+    }
+    const __m256 odd_sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+    for (int m = 0; m < M; m++) {
+        __m256 product = _mm256_add_ps(_mm256_xor_ps(acc_re[m], odd_sign),
+                                       _mm256_permute_ps(acc_im[m], 0xB1));
+        float* s = sum + 2 * (m * dist + k);
+        _mm256_storeu_ps(s, _mm256_add_ps(_mm256_loadu_ps(s), product));
+    }
+}
+#elif defined(__SSE3__)
+// Bins [k, k + 2) of M pairs, with the 2·M sums held in registers over all rows
+template <int M>
+static void cross_sse(const float* a, const float* b, size_t rows, size_t stride, size_t dist,
+                      size_t k, float* sum) {
+    __m128 acc_re[M], acc_im[M];
+    for (int m = 0; m < M; m++) {
+        acc_re[m] = _mm_setzero_ps();
+        acc_im[m] = _mm_setzero_ps();
+    }
+    for (size_t r = 0; r < rows; r++) {
+        __m128 va = _mm_loadu_ps(a + 2 * (r * stride + k));
+        __m128 re = _mm_moveldup_ps(va);
+        __m128 im = _mm_movehdup_ps(va);
+        for (int m = 0; m < M; m++) {
+            __m128 vb = _mm_loadu_ps(b + 2 * (r * stride + m * dist + k));
+            acc_re[m] = _mm_add_ps(acc_re[m], _mm_mul_ps(re, vb));
+            acc_im[m] = _mm_add_ps(acc_im[m], _mm_mul_ps(im, vb));
+        }
+    }
+    const __m128 odd_sign = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+    for (int m = 0; m < M; m++) {
+        __m128 product = _mm_add_ps(_mm_xor_ps(acc_re[m], odd_sign),
+                                    _mm_shuffle_ps(acc_im[m], acc_im[m], 0xB1));
+        float* s = sum + 2 * (m * dist + k);
+        _mm_storeu_ps(s, _mm_add_ps(_mm_loadu_ps(s), product));
+    }
+}
+#endif
+
+void cross_accumulate(const fftwf_complex* a, const fftwf_complex* b, size_t count, size_t rows,
+                      size_t stride, size_t dist, size_t n, fftwf_complex* sum) {
+    const float* af = reinterpret_cast<const float*>(a);
+    const float* bf = reinterpret_cast<const float*>(b);
+    float* sf = reinterpret_cast<float*>(sum);
+    size_t k = 0;
+
+    // Lanes are bins; four pairs share each load of a and give eight
+    // independent dependency chains per group of bins
+#if defined(__AVX__)
+    for (; k + 4 <= n; k += 4) {
+        size_t m = 0;
+        for (; m + 4 <= count; m += 4) {
+            cross_avx<4>(af, bf + 2 * m * dist, rows, stride, dist, k, sf + 2 * m * dist);
+        }
+        for (; m < count; m++) {
+            cross_avx<1>(af, bf + 2 * m * dist, rows, stride, dist, k, sf + 2 * m * dist);
+        }
+    }
+#elif defined(__SSE3__)
+    for (; k + 2 <= n; k += 2) {
+        size_t m = 0;
+        for (; m + 4 <= count; m += 4) {
+            cross_sse<4>(af, bf + 2 * m * dist, rows, stride, dist, k, sf + 2 * m * dist);
+        }
+        for (; m < count; m++) {
+            cross_sse<1>(af, bf + 2 * m * dist, rows, stride, dist, k, sf + 2 * m * dist);
+        }
+    }
+#endif
+    for (size_t m = 0; m < count; m++) {
+        for (size_t j = k; j < n; j++) {
+            float re = 0.0f;
+            float im = 0.0f;
+            for (size_t r = 0; r < rows; r++) {
+                const float* x = af + 2 * (r * stride + j);
+                const float* y = bf + 2 * (r * stride + m * dist + j);
+                re += x[0] * y[0] + x[1] * y[1];
+                im += x[1] * y[0] - x[0] * y[1];
+            }
+            sf[2 * (m * dist + j)] += re;
+            sf[2 * (m * dist + j) + 1] += im;
+        }
+    }
+}
+
+void magnitude(const fftwf_complex* x, float* y, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    size_t i = 0;
+
+    // hadd of the squares sums each re/im pair, in the order x0 x1 x4 x5 |
+    // x2 x3 x6 x7 for AVX (x0 x1 x2 x3 for SSE)
+#if defined(__AVX__)
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_loadu_ps(xf + 2 * i);
+        __m256 b = _mm256_loadu_ps(xf + 2 * i + 8);
+        __m256 r = _mm256_sqrt_ps(_mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b)));
+        __m128 lo = _mm256_castps256_ps128(r);
+        __m128 hi = _mm256_extractf128_ps(r, 1);
+        _mm_storeu_ps(y + i, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(1, 0, 1, 0)));
+        _mm_storeu_ps(y + i + 4, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 2, 3, 2)));
+    }
+#elif defined(__SSE3__)
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(xf + 2 * i);
+        __m128 b = _mm_loadu_ps(xf + 2 * i + 4);
+        _mm_storeu_ps(y + i, _mm_sqrt_ps(_mm_hadd_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b))));
+    }
+#endif
+    for (; i < n; i++) {
+        y[i] = std::sqrt(xf[2 * i] * xf[2 * i] + xf[2 * i + 1] * xf[2 * i + 1]);
+    }
+}
+
+void quantize(const float* x, const float* inv_step, int16_t* q, size_t n) {
+    size_t i = 0;
+
+    // cvtps rounds to nearest even, packs saturates to int16
+#if defined(__AVX__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(inv_step + i)));
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extractf128_si256(v, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), packed);
+    }
+#elif defined(__SSE3__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(inv_step + i)));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(inv_step + i + 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < n; i++) {
+        float v = std::nearbyint(x[i] * inv_step[i]);
+        q[i] = static_cast<int16_t>(std::min(32767.0f, std::max(-32768.0f, v)));
+    }
+}
+
+// Q15 product rounded to nearest, as pmulhrsw computes it
+static inline int16_t mulhrs16(int16_t a, int16_t b) {
+    return static_cast<int16_t>((static_cast<int32_t>(a) * b + 0x4000) >> 15);
+}
+
+static inline int16_t saturate16(int32_t v) {
+    return static_cast<int16_t>(std::min(32767, std::max(-32768, v)));
+}
+
+static inline unsigned abs16(int16_t v) {
+    return static_cast<unsigned>(v < 0 ? -static_cast<int32_t>(v) : v);
+}
+
+// Scalar complex sample of the int16 kernels
+struct Sc16 {
+    int16_t re;
+    int16_t im;
+};
+
+static inline Sc16 load_sc16(const int16_t* x, size_t i, int16_t factor) {
+    Sc16 v = {x[2 * i], x[2 * i + 1]};
+    if (factor != 0) {
+        v.re = mulhrs16(v.re, factor);
+        v.im = mulhrs16(v.im, factor);
+    }
+    return v;
+}
+
+static inline Sc16 add_sc16(Sc16 a, Sc16 b) {
+    Sc16 v = {saturate16(a.re + b.re), saturate16(a.im + b.im)};
+    return v;
+}
+
+static inline Sc16 sub_sc16(Sc16 a, Sc16 b) {
+    Sc16 v = {saturate16(a.re - b.re), saturate16(a.im - b.im)};
+    return v;
+}
+
+// d·w with w stored as (wr, wr) in w_re and (-wi, wi) in w_im at entry k
+static inline Sc16 twiddle_sc16(Sc16 d, const int16_t* w_re, const int16_t* w_im, size_t k) {
+    Sc16 v = {saturate16(mulhrs16(d.re, w_re[2 * k]) + mulhrs16(d.im, w_im[2 * k])),
+              saturate16(mulhrs16(d.im, w_re[2 * k]) + mulhrs16(d.re, w_im[2 * k + 1]))};
+    return v;
+}
+
+static inline unsigned store_sc16(int16_t* y, size_t i, Sc16 v) {
+    y[2 * i] = v.re;
+    y[2 * i + 1] = v.im;
+    return std::max(abs16(v.re), abs16(v.im));
+}
+
+#if defined(__AVX2__)
+static inline unsigned max_epu16_lanes(__m256i v) {
+    __m128i m = _mm_max_epu16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    uint16_t lanes[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), m);
+    unsigned peak = 0;
+    for (int i = 0; i < 8; i++) {
+        peak = std::max<unsigned>(peak, lanes[i]);
+    }
+    return peak;
+}
+
+static inline __m256i load_scaled(const int16_t* x, size_t i, unsigned shift, __m256i scale) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + 2 * i));
+    return shift > 0 ? _mm256_mulhrs_epi16(v, scale) : v;
+}
+
+// Twiddles of samples i..i + 7: entry (i / s)·s, a broadcast once s >= 8,
+// below that the loaded entries with even ones (s = 2) or every fourth
+// (s = 4) repeated
+static inline void load_twiddles(const int16_t* w_re, const int16_t* w_im, size_t i, size_t s,
+                                 __m256i& wr, __m256i& wi) {
+    if (s >= 8) {
+        size_t k = i & ~(s - 1);
+        int32_t re_pair;
+        int32_t im_pair;
+        memcpy(&re_pair, w_re + 2 * k, sizeof(re_pair));
+        memcpy(&im_pair, w_im + 2 * k, sizeof(im_pair));
+        wr = _mm256_set1_epi32(re_pair);
+        wi = _mm256_set1_epi32(im_pair);
+        return;
+    }
+    wr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w_re + 2 * i));
+    wi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w_im + 2 * i));
+    if (s == 2) {
+        wr = _mm256_shuffle_epi32(wr, 0xA0);
+        wi = _mm256_shuffle_epi32(wi, 0xA0);
+    } else if (s == 4) {
+        wr = _mm256_shuffle_epi32(wr, 0x00);
+        wi = _mm256_shuffle_epi32(wi, 0x00);
+    }
+}
+
+// (dr·wr - di·wi, di·wr + dr·wi) from (dr, di)·(wr, wr) + (di, dr)·(-wi, wi)
+static inline __m256i twiddle_sc16x8(__m256i d, __m256i wr, __m256i wi) {
+    const __m256i swap = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    return _mm256_adds_epi16(_mm256_mulhrs_epi16(d, wr), _mm256_mulhrs_epi16(_mm256_shuffle_epi8(d, swap), wi));
+}
+
+static inline __m256i peak_sc16x8(__m256i high, __m256i v) {
+    return _mm256_max_epu16(high, _mm256_abs_epi16(v));
+}
+#endif
+
+unsigned bfp_radix2_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift) {
+    const size_t h = n / 2;
+    const int16_t factor = static_cast<int16_t>(shift > 0 ? 1 << (15 - shift) : 0);
+    unsigned peak = 0;
+    size_t i = 0;
+
+    // Eight complex samples per register; below s = 8 the outputs
+    // interleave in runs of s samples
+#if defined(__AVX2__)
+    const __m256i scale = _mm256_set1_epi16(factor);
+    __m256i high = _mm256_setzero_si256();
+    for (; i + 8 <= h; i += 8) {
+        __m256i a = load_scaled(x, i, shift, scale);
+        __m256i b = load_scaled(x, i + h, shift, scale);
+        __m256i wr;
+        __m256i wi;
+        load_twiddles(w_re, w_im, i, s, wr, wi);
+        __m256i sum = _mm256_adds_epi16(a, b);
+        __m256i dw = twiddle_sc16x8(_mm256_subs_epi16(a, b), wr, wi);
+        high = peak_sc16x8(peak_sc16x8(high, sum), dw);
+
+        __m256i lo;
+        __m256i hi;
+        if (s >= 8) {
+            int16_t* out = y + 2 * (i + (i & ~(s - 1)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), sum);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * s), dw);
+            continue;
+        } else if (s == 4) {
+            lo = sum;
+            hi = dw;
+        } else if (s == 2) {
+            lo = _mm256_unpacklo_epi64(sum, dw);
+            hi = _mm256_unpackhi_epi64(sum, dw);
+        } else {
+            lo = _mm256_unpacklo_epi32(sum, dw);
+            hi = _mm256_unpackhi_epi32(sum, dw);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + 4 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + 4 * i + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    peak = max_epu16_lanes(high);
+#endif
+    for (; i < h; i++) {
+        Sc16 a = load_sc16(x, i, factor);
+        Sc16 b = load_sc16(x, i + h, factor);
+        size_t k = i & ~(s - 1);
+        size_t out = k + i;
+        peak = std::max(peak, store_sc16(y, out, add_sc16(a, b)));
+        peak = std::max(peak, store_sc16(y, out + s, twiddle_sc16(sub_sc16(a, b), w_re, w_im, k)));
+    }
+    return peak;
+}
+
+unsigned bfp_radix4_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift) {
+    const size_t q = n / 4;
+    const int16_t factor = static_cast<int16_t>(shift > 0 ? 1 << (15 - shift) : 0);
+    const int16_t* w2_re = w_re + 2 * q;
+    const int16_t* w2_im = w_im + 2 * q;
+    const int16_t* w3_re = w_re + 4 * q;
+    const int16_t* w3_im = w_im + 4 * q;
+    unsigned peak = 0;
+    size_t i = 0;
+
+    // The four outputs of eight butterflies; below s = 8 they are
+    // transposed into runs of s samples per output
+#if defined(__AVX2__)
+    const __m256i scale = _mm256_set1_epi16(factor);
+    const __m256i swap = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i conj = _mm256_set1_epi32(0xFFFF0001);     // (+1, -1) per sample
+    __m256i high = _mm256_setzero_si256();
+    for (; i + 8 <= q; i += 8) {
+        __m256i a0 = load_scaled(x, i, shift, scale);
+        __m256i a1 = load_scaled(x, i + q, shift, scale);
+        __m256i a2 = load_scaled(x, i + 2 * q, shift, scale);
+        __m256i a3 = load_scaled(x, i + 3 * q, shift, scale);
+        __m256i b0 = _mm256_adds_epi16(a0, a2);
+        __m256i b1 = _mm256_subs_epi16(a0, a2);
+        __m256i b2 = _mm256_adds_epi16(a1, a3);
+        // -i·(a1 - a3) = (di, -dr)
+        __m256i b3 = _mm256_sign_epi16(_mm256_shuffle_epi8(_mm256_subs_epi16(a1, a3), swap), conj);
+
+        __m256i wr;
+        __m256i wi;
+        __m256i out[4];
+        out[0] = _mm256_adds_epi16(b0, b2);
+        load_twiddles(w_re, w_im, i, s, wr, wi);
+        out[1] = twiddle_sc16x8(_mm256_adds_epi16(b1, b3), wr, wi);
+        load_twiddles(w2_re, w2_im, i, s, wr, wi);
+        out[2] = twiddle_sc16x8(_mm256_subs_epi16(b0, b2), wr, wi);
+        load_twiddles(w3_re, w3_im, i, s, wr, wi);
+        out[3] = twiddle_sc16x8(_mm256_subs_epi16(b1, b3), wr, wi);
+        for (int j = 0; j < 4; j++) {
+            high = peak_sc16x8(high, out[j]);
+        }
+
+        if (s >= 8) {
+            int16_t* base = y + 2 * (i + 3 * (i & ~(s - 1)));
+            for (int j = 0; j < 4; j++) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(base + 2 * j * s), out[j]);
+            }
+            continue;
+        }
+        __m256i v[4];
+        if (s == 4) {
+            v[0] = _mm256_permute2x128_si256(out[0], out[1], 0x20);
+            v[1] = _mm256_permute2x128_si256(out[2], out[3], 0x20);
+            v[2] = _mm256_permute2x128_si256(out[0], out[1], 0x31);
+            v[3] = _mm256_permute2x128_si256(out[2], out[3], 0x31);
+        } else {
+            __m256i t0;
+            __m256i t1;
+            __m256i t2;
+            __m256i t3;
+            if (s == 2) {
+                t0 = _mm256_unpacklo_epi64(out[0], out[1]);
+                t1 = _mm256_unpackhi_epi64(out[0], out[1]);
+                t2 = _mm256_unpacklo_epi64(out[2], out[3]);
+                t3 = _mm256_unpackhi_epi64(out[2], out[3]);
+            } else {
+                __m256i u0 = _mm256_unpacklo_epi32(out[0], out[1]);
+                __m256i u1 = _mm256_unpackhi_epi32(out[0], out[1]);
+                __m256i u2 = _mm256_unpacklo_epi32(out[2], out[3]);
+                __m256i u3 = _mm256_unpackhi_epi32(out[2], out[3]);
+                t0 = _mm256_unpacklo_epi64(u0, u2);
+                t1 = _mm256_unpackhi_epi64(u0, u2);
+                t2 = _mm256_unpacklo_epi64(u1, u3);
+                t3 = _mm256_unpackhi_epi64(u1, u3);
+            }
+            if (s == 2) {
+                v[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+                v[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+                v[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+                v[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+            } else {
+                v[0] = _mm256_permute2x128_si256(t0, t1, 0x20);
+                v[1] = _mm256_permute2x128_si256(t2, t3, 0x20);
+                v[2] = _mm256_permute2x128_si256(t0, t1, 0x31);
+                v[3] = _mm256_permute2x128_si256(t2, t3, 0x31);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + 8 * i + 16 * j), v[j]);
+        }
+    }
+    peak = max_epu16_lanes(high);
+#endif
+    for (; i < q; i++) {
+        Sc16 a0 = load_sc16(x, i, factor);
+        Sc16 a1 = load_sc16(x, i + q, factor);
+        Sc16 a2 = load_sc16(x, i + 2 * q, factor);
+        Sc16 a3 = load_sc16(x, i + 3 * q, factor);
+        Sc16 b0 = add_sc16(a0, a2);
+        Sc16 b1 = sub_sc16(a0, a2);
+        Sc16 b2 = add_sc16(a1, a3);
+        Sc16 d = sub_sc16(a1, a3);
+        Sc16 b3 = {d.im, static_cast<int16_t>(-d.re)};
+        size_t k = i & ~(s - 1);
+        size_t out = i + 3 * k;
+        peak = std::max(peak, store_sc16(y, out, add_sc16(b0, b2)));
+        peak = std::max(peak, store_sc16(y, out + s, twiddle_sc16(add_sc16(b1, b3), w_re, w_im, k)));
+        peak = std::max(peak, store_sc16(y, out + 2 * s, twiddle_sc16(sub_sc16(b0, b2), w2_re, w2_im, k)));
+        peak = std::max(peak, store_sc16(y, out + 3 * s, twiddle_sc16(sub_sc16(b1, b3), w3_re, w3_im, k)));
+    }
+    return peak;
+}
+
+unsigned max_abs_int16(const int16_t* x, size_t n) {
+    unsigned peak = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i high = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        high = _mm256_max_epu16(high, _mm256_abs_epi16(v));
+    }
+    peak = max_epu16_lanes(high);
+#endif
+    for (; i < n; i++) {
+        peak = std::max(peak, abs16(x[i]));
+    }
+    return peak;
+}
+
+// Runs over k in the outer loop so the inner loop over a short run of
+// outputs vectorizes without reassociating a reduction
+void direct_convolve(const fftwf_complex* x, const float* h, size_t taps,
+                     fftwf_complex* y, size_t count) {
+    const size_t run = 512;
+    for (size_t n0 = 0; n0 < count; n0 += run) {
+        size_t m = std::min(run, count - n0);
+        memset(y + n0, 0, m * sizeof(fftwf_complex));
+        for (size_t k = 0; k < taps; k++) {
+            float hk = h[k];
+            const fftwf_complex* xs = x + n0 + (taps - 1) - k;
+            for (size_t i = 0; i < m; i++) {
+                y[n0 + i][0] += hk * xs[i][0];
+                y[n0 + i][1] += hk * xs[i][1];
+            }
+        }
+    }
+}
+
+void stream_copy(const fftwf_complex* in, fftwf_complex* out, size_t n) {
+    const float* inf = reinterpret_cast<const float*>(in);
+    float* outf = reinterpret_cast<float*>(out);
+    const size_t m = 2 * n;
+    size_t i = 0;
+
+    // Plain stores up to the first aligned vector, then whole vectors with
+    // non-temporal stores; the fence orders them before anything that follows
+#if defined(__AVX__)
+    while (i < m && (reinterpret_cast<uintptr_t>(outf + i) & 31) != 0) {
+        outf[i] = inf[i];
+        i++;
+    }
+    for (; i + 8 <= m; i += 8) {
+        _mm256_stream_ps(outf + i, _mm256_loadu_ps(inf + i));
+    }
+    _mm_sfence();
+#elif defined(__SSE2__)
+    while (i < m && (reinterpret_cast<uintptr_t>(outf + i) & 15) != 0) {
+        outf[i] = inf[i];
+        i++;
+    }
+    for (; i + 4 <= m; i += 4) {
+        _mm_stream_ps(outf + i, _mm_loadu_ps(inf + i));
+    }
+    _mm_sfence();
+#endif
+    memcpy(outf + i, inf + i, (m - i) * sizeof(float));
+}
+
+void generate_tones(fftwf_complex* data, size_t batch, size_t length) {
+    float* out = reinterpret_cast<float*>(data);
+    const double inv_length = 1.0 / static_cast<double>(length);
+    const float two_pi = 6.28318530717958647692f;
+    for (size_t s = 0; s < batch; s++) {
+        double cycles = static_cast<double>(s + 1) * inv_length;
+        float* row = out + 2 * s * length;
+        for (size_t i = 0; i < length; i++) {
+            // Turns reduced to y in [-1/2, 1/2], then cos(2πy) = sin(a) with
+            // a = 2π(1/4 - |y|) in [-π/2, π/2], odd Taylor series to a^11
+            double turns = cycles * static_cast<double>(i);
+            float y = static_cast<float>(turns - std::floor(turns + 0.5));
+            float a = two_pi * (0.25f - std::fabs(y));
+            float a2 = a * a;
+            float p = -1.0f / 39916800.0f;
+            p = p * a2 + 1.0f / 362880.0f;
+            p = p * a2 - 1.0f / 5040.0f;
+            p = p * a2 + 1.0f / 120.0f;
+            p = p * a2 - 1.0f / 6.0f;
+            row[2 * i] = a + a * a2 * p;
+            row[2 * i + 1] = 0.0f;
+        }
+    }
+}
+
+extern const KernelTable kernel_table = {
+    BATCH_FFT_ISA_NAME,
+    apply_window,
+    accumulate_power,
+    multiply_complex,
+    multiply_spectrum,
+    multiply_conj_spectrum,
+    complex_dot,
+    goertzel_update,
+    max_power_index,
+    transpose,
+    twiddle_rows,
+    polyphase_fir,
+    cross_accumulate,
+    magnitude,
+    quantize,
+    bfp_radix2_stage,
+    bfp_radix4_stage,
+    max_abs_int16,
+    direct_convolve,
+    stream_copy,
+    generate_tones,
+    find_fixed_fft,
+    find_vertical_groups,
+};
+
+} // namespace BATCH_FFT_ISA
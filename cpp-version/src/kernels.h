@@ -0,0 +1,113 @@
+#ifndef BATCH_FFT_KERNELS_H
+#define BATCH_FFT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+
+// Inner loops run between FFTW passes. They work on data that is already in
+// cache, so they are written to vectorize and never allocate. kernels.cpp is
+// compiled once per ISA level; these entry points forward to the copy picked
+// at startup (dispatch.h).
+
+// out[i] = in[i] * w[i]
+void apply_window(const fftwf_complex* in, const float* w, fftwf_complex* out, size_t n);
+
+// sum[i] += |x[i]|²
+void accumulate_power(const fftwf_complex* x, float* sum, size_t n);
+
+// y[i] = x[i] * h[i] (complex); y may alias x
+void multiply_complex(const fftwf_complex* x, const fftwf_complex* h, fftwf_complex* y, size_t n);
+
+// x[i] *= h[i] (complex)
+void multiply_spectrum(fftwf_complex* x, const fftwf_complex* h, size_t n);
+
+// x[i] = x[i] * conj(y[i]) * scale
+void multiply_conj_spectrum(fftwf_complex* x, const fftwf_complex* y, size_t n, float scale);
+
+// *result = Σ a[i] * b[i] (complex)
+void complex_dot(const fftwf_complex* a, const fftwf_complex* b, size_t n, fftwf_complex* result);
+
+// Goertzel recurrences s[n] = x[n] + 2cos(ω)·s[n-1] - s[n-2] over the real
+// and imaginary parts of `signals` signals, `stride` samples apart, for
+// `bins` frequencies at once (coeffs[b] = 2cos(ω_b)). `state` holds, per
+// signal, the rows s[n-1].re, s[n-2].re, s[n-1].im, s[n-2].im of `bins`
+// floats each and is updated in place, so long signals can be fed in
+// cache-sized pieces.
+void goertzel_update(const fftwf_complex* x, size_t stride, size_t signals, size_t n,
+                     const float* coeffs, size_t bins, float* state);
+
+// Index of the largest |x[i]|² over [begin, end)
+size_t max_power_index(const fftwf_complex* x, size_t begin, size_t end);
+
+// out[c * out_stride + r] = in[r * in_stride + c] for r < rows, c < cols,
+// in blocks of 16 rows by 8 columns, row blocks outer. With
+// `prefetch` > 0 the input lines of the block that many blocks further on
+// are prefetched: strided rows start a new page each, where the hardware
+// prefetcher stops. Pass 0 when the input is already in cache, and
+// prefetch_distance() (layout.h) when it is coming from memory.
+void transpose(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+               fftwf_complex* out, size_t out_stride, size_t prefetch);
+
+// out[r * out_stride + c] = in[r * in_stride + c] * t[c] for r < rows,
+// c < cols, with t[c] *= step[c] after every row: twiddles t[c]·step[c]^r
+// from a running recurrence. t is left advanced by `rows` steps so the
+// caller can continue it or reseed it exactly. out may alias in.
+void twiddle_rows(const fftwf_complex* in, size_t rows, size_t cols, size_t in_stride,
+                  fftwf_complex* out, size_t out_stride, fftwf_complex* t, const fftwf_complex* step);
+
+// Polyphase FIR branch sums for one output frame of a filter bank:
+//   y[m] = Σ_p h[p*channels + m] * x[p*channels + m],  m < channels, p < taps
+// `h2` holds each real coefficient twice (h2[2i] = h2[2i + 1] = h[i]) so the
+// products with interleaved complex samples need no shuffles.
+void polyphase_fir(const fftwf_complex* x, const float* h2, size_t taps, size_t channels,
+                   fftwf_complex* y);
+
+// Cross products over bins k < n of one channel with `count` channels,
+// summed over `rows` frames `stride` samples apart; channel m of b and of
+// sum starts m * dist samples in:
+//   sum[m * dist + k] += Σ_r a[r * stride + k] * conj(b[r * stride + m * dist + k])
+void cross_accumulate(const fftwf_complex* a, const fftwf_complex* b, size_t count, size_t rows,
+                      size_t stride, size_t dist, size_t n, fftwf_complex* sum);
+
+// y[i] = |x[i]|
+void magnitude(const fftwf_complex* x, float* y, size_t n);
+
+// q[i] = x[i] * inv_step[i] rounded to nearest (ties to even), saturated to int16
+void quantize(const float* x, const float* inv_step, int16_t* q, size_t n);
+
+// Stockham stages of the block-floating-point int16 FFT (bfp.h) on n
+// complex samples, (re, im) int16 pairs. Inputs are x[i] / 2^shift,
+// rounded. The Q15 twiddles are stored as pairs (wr, wr) in w_re and
+// (-wi, wi) in w_im so one complex product is two rounded multiplies
+// (pmulhrsw) and an add. Sums saturate. Both return the largest |component|
+// written, which picks the next stage's shift.
+//
+// Radix 2, with h = n / 2 and k = (i / s)·s for i < h:
+//   y[i + k] = a + b,  y[i + k + s] = (a - b)·w[k]
+// where a = x[i], b = x[i + h] and w[k] = W_n^k, k < h.
+unsigned bfp_radix2_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift);
+
+// Radix 4, with q = n / 4 and k = (i / s)·s for i < q:
+//   y[i + 3k + j·s] = W_n^(j·k) · Σ_m (-i)^(j·m) x[i + m·q],  j < 4
+// The twiddle arrays hold three tables of q pairs, W_n^k, W_n^2k, W_n^3k.
+unsigned bfp_radix4_stage(const int16_t* x, int16_t* y, size_t n, size_t s, const int16_t* w_re,
+                          const int16_t* w_im, unsigned shift);
+
+// Largest |x[i]| over n int16 values
+unsigned max_abs_int16(const int16_t* x, size_t n);
+
+// y[n] = Σ h[k] x[n - k] for n < count (real taps, complex samples). x points
+// at taps - 1 samples of history in front of the signal.
+void direct_convolve(const fftwf_complex* x, const float* h, size_t taps, fftwf_complex* y, size_t count);
+
+// out[i] = in[i] with non-temporal stores where the ISA has them, so the
+// output neither displaces cached data nor is read for ownership first
+void stream_copy(const fftwf_complex* in, fftwf_complex* out, size_t n);
+
+// Benchmark input: signal s < batch is the tone cos(2π(1 + s)·i / length),
+// with the phase reduced exactly before the float polynomial
+void generate_tones(fftwf_complex* data, size_t batch, size_t length);
+
+#endif // BATCH_FFT_KERNELS_H
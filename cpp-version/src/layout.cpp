@@ -0,0 +1,140 @@
+#include "layout.h"
+#include "common.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Signals per gather, and the multiple tiles are rounded to: a row of the
+// tile is whole cache lines of each input row, however long the signals are
+static const size_t MIN_GATHER_TILE = 8;
+
+static fftwf_plan plan_tile(size_t length, size_t count, fftwf_complex* data, unsigned flags) {
+    int n[] = {static_cast<int>(length)};
+    return fftwf_plan_many_dft(
+        1, n, static_cast<int>(count),
+        data, NULL, 1, static_cast<int>(length),
+        data, NULL, 1, static_cast<int>(length),
+        FFTW_FORWARD, flags);
+}
+
+bool create_gather_batch(GatherBatch& gb, size_t batch, size_t length, size_t stride, int threads) {
+    gb.batch = batch;
+    gb.length = length;
+    gb.stride = stride;
+    size_t signal_bytes = length * sizeof(fftwf_complex);
+    gb.tile = std::max(MIN_GATHER_TILE, cache_size(2) / 2 / signal_bytes);
+    gb.tile -= gb.tile % MIN_GATHER_TILE;
+    gb.tile = std::min(gb.tile, batch);
+    size_t tiles = (batch + gb.tile - 1) / gb.tile;
+    gb.workers = std::min<size_t>(static_cast<size_t>(threads), tiles);
+    gb.prefetch = prefetch_distance();
+
+    // Output tiles start tile * length samples apart
+    unsigned flags = FFTW_MEASURE;
+    if (!keeps_alignment(gb.tile * length)) {
+        flags |= FFTW_UNALIGNED;
+    }
+
+    // Planned on scratch so measuring does not clobber the caller's data;
+    // single-threaded, the workers run it in parallel
+    fftwf_complex* scratch = fftwf_alloc_complex(gb.tile * length);
+    fftwf_plan_with_nthreads(1);
+    size_t tail = batch % gb.tile;
+    gb.plan = plan_tile(length, gb.tile, scratch, flags);
+    gb.tail_plan = tail > 0 ? plan_tile(length, tail, scratch, flags) : NULL;
+    fftwf_plan_with_nthreads(threads);
+    fftwf_free(scratch);
+    return gb.plan != NULL && (tail == 0 || gb.tail_plan != NULL);
+}
+
+void destroy_gather_batch(GatherBatch& gb) {
+    if (gb.plan != NULL) {
+        fftwf_destroy_plan(gb.plan);
+    }
+    if (gb.tail_plan != NULL) {
+        fftwf_destroy_plan(gb.tail_plan);
+    }
+    gb.plan = NULL;
+    gb.tail_plan = NULL;
+}
+
+// Tiles id, id + workers, ...: gather the tile's signals, transform them
+static void gather_worker(const GatherBatch& gb, const fftwf_complex* in, fftwf_complex* out, size_t id) {
+    const size_t tiles = (gb.batch + gb.tile - 1) / gb.tile;
+    for (size_t t = id; t < tiles; t += gb.workers) {
+        size_t first = t * gb.tile;
+        size_t count = std::min(gb.tile, gb.batch - first);
+        fftwf_complex* dst = out + first * gb.length;
+        transpose(in + first, gb.length, count, gb.stride, dst, gb.length, gb.prefetch);
+        fftwf_execute_dft(count == gb.tile ? gb.plan : gb.tail_plan, dst, dst);
+    }
+}
+
+void execute_gather_batch(const GatherBatch& gb, const fftwf_complex* in, fftwf_complex* out) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < gb.workers; id++) {
+        pool.push_back(std::thread(gather_worker, std::cref(gb), in, out, id));
+    }
+    gather_worker(gb, in, out, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+// Candidate distances in blocks; a block is 16 rows of one cache line
+static const size_t PREFETCH_CANDIDATES[] = {0, 1, 2, 4, 8, 16};
+static const size_t PROBE_COLUMNS = 64;
+
+// Gather every PROBE_COLUMNS-wide strip of the probe into one tile, the
+// access pattern of execute_gather_batch and of the N-d strip passes; the
+// distance with the fastest of three sweeps wins
+static size_t tune_prefetch_distance() {
+    const size_t stride = 1024;
+    const size_t rows = std::max<size_t>(64, 4 * cache_size(2) / (stride * sizeof(fftwf_complex)));
+    fftwf_complex* probe = fftwf_alloc_complex(rows * stride);
+    fftwf_complex* tile = fftwf_alloc_complex(rows * PROBE_COLUMNS);
+    memset(probe, 0, rows * stride * sizeof(fftwf_complex));
+
+    size_t best = 0;
+    double best_time = 0.0;
+    const size_t candidates = sizeof(PREFETCH_CANDIDATES) / sizeof(PREFETCH_CANDIDATES[0]);
+    for (size_t i = 0; i < candidates; i++) {
+        for (int sweep = 0; sweep < 3; sweep++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t c = 0; c < stride; c += PROBE_COLUMNS) {
+                transpose(probe + c, rows, PROBE_COLUMNS, stride, tile, rows, PREFETCH_CANDIDATES[i]);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double time = std::chrono::duration<double>(end - start).count();
+            if ((i == 0 && sweep == 0) || time < best_time) {
+                best = PREFETCH_CANDIDATES[i];
+                best_time = time;
+            }
+        }
+    }
+    fftwf_free(tile);
+    fftwf_free(probe);
+    return best;
+}
+
+static size_t select_prefetch_distance() {
+    const char* forced = std::getenv("BATCH_FFT_PREFETCH");
+    if (forced != NULL && forced[0] != '\0') {
+        return static_cast<size_t>(std::atoi(forced));
+    }
+    size_t distance = tune_prefetch_distance();
+    std::cerr << "prefetch: " << distance << " blocks\n";
+    return distance;
+}
+
+size_t prefetch_distance() {
+    static const size_t distance = select_prefetch_distance();
+    return distance;
+}
@@ -0,0 +1,45 @@
+#ifndef BATCH_FFT_LAYOUT_H
+#define BATCH_FFT_LAYOUT_H
+
+#include <cstddef>
+#include <fftw3.h>
+
+// Batches that do not arrive as contiguous signals. In sample-major
+// ("interleaved") input, sample i of signal s is at in[i·batch + s], the
+// way a multichannel digitizer or a corner-turned radar cube writes it.
+// FFTW can read it directly with istride = batch, idist = 1, but each
+// transform then walks memory a row at a time, a new page per sample.
+// Instead, tiles of signals sized to half of L2 are gathered by transpose() into
+// their place in the contiguous output, prefetching the input rows ahead,
+// and transformed there in place with a contiguous plan while the tile is
+// still in cache.
+struct GatherBatch {
+    size_t batch;
+    size_t length;
+    size_t stride;          // input samples between consecutive samples of a signal
+    size_t tile;            // signals per tile
+    size_t workers;         // tiles id, id + workers, ... per worker
+    size_t prefetch;        // transpose() distance, from prefetch_distance()
+    fftwf_plan plan;        // one tile, in place
+    fftwf_plan tail_plan;   // the last, partial tile; NULL if there is none
+};
+
+// `stride` is `batch` for a whole interleaved array and larger for the
+// first signals of one. Returns false if FFTW could not create a plan;
+// destroy_gather_batch must still be called.
+bool create_gather_batch(GatherBatch& gb, size_t batch, size_t length, size_t stride, int threads);
+
+// Transform `batch` interleaved signals from `in` into contiguous signals
+// in `out`
+void execute_gather_batch(const GatherBatch& gb, const fftwf_complex* in, fftwf_complex* out);
+
+void destroy_gather_batch(GatherBatch& gb);
+
+// Blocks ahead that transpose() prefetches when its input comes from
+// memory (kernels.h). Measured once per process by timing strided gathers
+// out of a probe array four times the size of L2 at each candidate
+// distance, or read from the environment variable BATCH_FFT_PREFETCH (0
+// turns prefetching off).
+size_t prefetch_distance();
+
+#endif // BATCH_FFT_LAYOUT_H
@@ -0,0 +1,20 @@
+#ifndef BATCH_FFT_ND_H
+#define BATCH_FFT_ND_H
+
+#include "common.h"
+
+// Batched 2D/3D transforms: `batch` contiguous row-major arrays of `dims`
+// (-d 512x512, -d 128x128x128), transformed in place.
+//
+// --method blocked (default) groups the trailing axes whose sub-array (a
+// slab: a row, an image of a stack, a plane of a volume) fits in half of L2
+// and transforms groups of slabs with an FFTW rank-k plan while they are in
+// cache. Each remaining outer axis is a cache-blocked column pass: strips of
+// up to 64 columns are transposed into a worker buffer, transformed as
+// contiguous rows and transposed back, so no transform walks memory at the
+// full row stride. --method fftw is FFTW's own rank-N plan over the batch.
+// Both are compared against running a 1D batch per axis over the whole
+// array (--method axes, one guru plan per axis).
+int run_nd(const Args& args);
+
+#endif // BATCH_FFT_ND_H
@@ -0,0 +1,213 @@
+#include "parallel.h"
+#include "common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(BATCH_FFT_OPENMP)
+#include <omp.h>
+#endif
+
+const char* threading_backend() {
+#if defined(BATCH_FFT_OPENMP)
+    return "openmp";
+#else
+    return "pthreads";
+#endif
+}
+
+void report_threading() {
+    std::cerr << "threading: " << threading_backend();
+#if defined(BATCH_FFT_OPENMP)
+    const char* policies[] = {"false", "true", "primary", "close", "spread"};
+    int bind = static_cast<int>(omp_get_proc_bind());
+    std::cerr << ", proc_bind " << (bind >= 0 && bind < 5 ? policies[bind] : "unknown") << ", "
+              << omp_get_num_places() << " places";
+#endif
+    std::cerr << "\n";
+}
+
+int available_cores() {
+#if defined(__linux__)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return std::max(1, CPU_COUNT(&set));
+    }
+#endif
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+static fftwf_plan plan_chunk(size_t length, size_t count, fftwf_complex* data, unsigned flags) {
+    int n[] = {static_cast<int>(length)};
+    return fftwf_plan_many_dft(
+        1, n, static_cast<int>(count),
+        data, NULL, 1, static_cast<int>(length),
+        data, NULL, 1, static_cast<int>(length),
+        FFTW_FORWARD, flags);
+}
+
+static bool plan_chunked_batch(ChunkedBatch& cb, fftwf_complex* data, size_t batch, size_t length,
+                               int threads, int inner, unsigned flags) {
+    cb.batch = batch;
+    cb.length = length;
+    cb.inner = std::max(1, std::min(inner, threads));
+    cb.chunks = std::min<size_t>(static_cast<size_t>(threads / cb.inner), batch);
+    cb.chunk = (batch + cb.chunks - 1) / cb.chunks;
+    cb.chunks = (batch + cb.chunk - 1) / cb.chunk;
+    cb.plan = NULL;
+    cb.tail_plan = NULL;
+
+    // Chunks start chunk * length samples apart, signals length apart
+    if (!keeps_alignment(cb.inner > 1 ? length : cb.chunk * length)) {
+        flags |= FFTW_UNALIGNED;
+    }
+    fftwf_plan_with_nthreads(cb.inner);
+    if (cb.inner > 1) {
+        cb.plan = plan_chunk(length, 1, data, flags);
+        fftwf_plan_with_nthreads(threads);
+        return cb.plan != NULL;
+    }
+    size_t tail = batch - (cb.chunks - 1) * cb.chunk;
+    cb.plan = plan_chunk(length, cb.chunk, data, flags);
+    cb.tail_plan = tail < cb.chunk ? plan_chunk(length, tail, data, flags) : NULL;
+    fftwf_plan_with_nthreads(threads);
+    return cb.plan != NULL && (tail == cb.chunk || cb.tail_plan != NULL);
+}
+
+bool create_chunked_batch(ChunkedBatch& cb, fftwf_complex* data, size_t batch, size_t length, int threads,
+                          int inner) {
+    return plan_chunked_batch(cb, data, batch, length, threads, inner, FFTW_MEASURE);
+}
+
+void destroy_chunked_batch(ChunkedBatch& cb) {
+    if (cb.plan != NULL) {
+        fftwf_destroy_plan(cb.plan);
+    }
+    if (cb.tail_plan != NULL) {
+        fftwf_destroy_plan(cb.tail_plan);
+    }
+    cb.plan = NULL;
+    cb.tail_plan = NULL;
+}
+
+static void execute_chunk(const ChunkedBatch& cb, fftwf_complex* data, size_t c) {
+    fftwf_complex* x = data + c * cb.chunk * cb.length;
+    bool tail = c + 1 == cb.chunks;
+    if (cb.inner > 1) {
+        size_t count = tail ? cb.batch - c * cb.chunk : cb.chunk;
+        for (size_t s = 0; s < count; s++) {
+            fftwf_execute_dft(cb.plan, x + s * cb.length, x + s * cb.length);
+        }
+        return;
+    }
+    fftwf_execute_dft(tail && cb.tail_plan != NULL ? cb.tail_plan : cb.plan, x, x);
+}
+
+void execute_chunked_batch(const ChunkedBatch& cb, fftwf_complex* data) {
+#if defined(BATCH_FFT_OPENMP)
+    // FFTW's own OpenMP threads nest inside the workers
+    if (cb.inner > 1) {
+        omp_set_max_active_levels(2);
+    }
+    #pragma omp parallel for schedule(static, 1) num_threads(static_cast<int>(cb.chunks))
+    for (size_t c = 0; c < cb.chunks; c++) {
+        execute_chunk(cb, data, c);
+    }
+#else
+    std::vector<std::thread> pool;
+    for (size_t c = 1; c < cb.chunks; c++) {
+        pool.push_back(std::thread(execute_chunk, std::cref(cb), data, c));
+    }
+    execute_chunk(cb, data, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+#endif
+}
+
+// Best of two timed passes after a warm-up, in seconds
+static double time_chunked_batch(const ChunkedBatch& cb, fftwf_complex* data) {
+    double best = 0.0;
+    for (int pass = 0; pass < 3; pass++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_chunked_batch(cb, data);
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (pass == 1 || (pass == 2 && seconds < best)) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+int choose_inner_threads(size_t batch, size_t length, int threads) {
+    if (threads <= 1) {
+        return 1;
+    }
+
+    // Signals per worker in the probe: about 64K samples, at least one,
+    // and no more than a worker would get from the real batch
+    size_t per_worker = std::max<size_t>(1, (size_t(1) << 16) / length);
+    per_worker = std::min(per_worker, (batch + threads - 1) / threads);
+    per_worker = std::max<size_t>(per_worker, 1);
+    std::vector<int> inner;
+    for (int i = 1; i < threads; i *= 2) {
+        inner.push_back(i);
+    }
+    inner.push_back(threads);
+
+    size_t probe = per_worker * static_cast<size_t>(threads);
+    fftwf_complex* buffer = fftwf_alloc_complex(probe * length);
+    for (size_t i = 0; i < probe * length; i++) {
+        buffer[i][0] = static_cast<float>(i % 7) - 3.0f;
+        buffer[i][1] = 0.0f;
+    }
+
+    // t(i): per_worker transforms by one worker threaded i ways. g(w):
+    // per_worker transforms on each of w single-threaded workers, against
+    // the same on one.
+    std::vector<double> t(inner.size());
+    std::vector<double> g(inner.size());
+    double alone = 0.0;
+    for (size_t k = 0; k < inner.size(); k++) {
+        ChunkedBatch cb;
+        bool planned = plan_chunked_batch(cb, buffer, per_worker, length, inner[k], inner[k], FFTW_ESTIMATE);
+        t[k] = planned ? time_chunked_batch(cb, buffer) / per_worker : 0.0;
+        destroy_chunked_batch(cb);
+        if (k == 0) {
+            alone = t[k];
+        }
+
+        int workers = threads / inner[k];
+        planned = plan_chunked_batch(cb, buffer, per_worker * workers, length, workers, 1, FFTW_ESTIMATE);
+        g[k] = planned && alone > 0.0 ? time_chunked_batch(cb, buffer) / per_worker / alone : 0.0;
+        destroy_chunked_batch(cb);
+    }
+    fftwf_plan_with_nthreads(threads);
+    fftwf_free(buffer);
+
+    int best = 1;
+    double best_time = 0.0;
+    for (size_t k = 0; k < inner.size(); k++) {
+        if (t[k] <= 0.0 || g[k] <= 0.0) {
+            continue;
+        }
+        size_t workers = static_cast<size_t>(threads / inner[k]);
+        double modeled = static_cast<double>((batch + workers - 1) / workers) * t[k] * g[k];
+        if (best_time == 0.0 || modeled < best_time) {
+            best = inner[k];
+            best_time = modeled;
+        }
+    }
+    std::cerr << "threads: " << threads / best << " workers x " << best << " per transform, modeled "
+              << best_time * 1000.0 << " ms\n";
+    return best;
+}
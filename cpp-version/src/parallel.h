@@ -0,0 +1,59 @@
+#ifndef BATCH_FFT_PARALLEL_H
+#define BATCH_FFT_PARALLEL_H
+
+#include <cstddef>
+#include <fftw3.h>
+
+// Threading backends. FFTW's own threads (fftwf_plan_with_nthreads: one
+// plan that splits the batch or each transform as its planner sees fit)
+// come from libfftw3f_threads in the pthreads build and from libfftw3f_omp
+// in the OpenMP build (CMake option BATCH_FFT_OPENMP); the two share the
+// API. Batch-parallel execution instead cuts the batch into one contiguous
+// chunk per worker, from an `omp parallel for` in the OpenMP build and from
+// std::thread otherwise. Each worker runs a single-threaded plan over its
+// chunk or, with `inner` threads per worker, a one-signal plan threaded
+// inside the transform, signal by signal. OpenMP threads are bound as
+// OMP_PROC_BIND and OMP_PLACES say.
+
+// "openmp" or "pthreads"
+const char* threading_backend();
+
+// Log the backend to stderr, under OpenMP with the binding policy and the
+// number of places
+void report_threading();
+
+// Cores this process may run on (its affinity mask where the OS has one)
+int available_cores();
+
+struct ChunkedBatch {
+    size_t batch;
+    size_t length;
+    size_t chunk;           // signals per chunk, the last one may have fewer
+    size_t chunks;          // one per worker
+    int inner;              // FFTW threads per transform
+    fftwf_plan plan;        // inner == 1: `chunk` signals, single-threaded; else one signal
+    fftwf_plan tail_plan;   // the last chunk's when it is shorter and inner == 1, else NULL
+};
+
+// Plan `batch` contiguous signals of `length` samples in `data` (measuring
+// overwrites it) for threads / inner workers. Returns false if FFTW could
+// not create a plan; destroy_chunked_batch must still be called.
+bool create_chunked_batch(ChunkedBatch& cb, fftwf_complex* data, size_t batch, size_t length, int threads,
+                          int inner);
+
+// Transform the batch in place, one chunk per worker
+void execute_chunked_batch(const ChunkedBatch& cb, fftwf_complex* data);
+
+void destroy_chunked_batch(ChunkedBatch& cb);
+
+// Pick `inner` for `threads` threads on this batch shape (--parallel auto).
+// With w = threads / inner workers the model is
+//   T(w, inner) = ⌈batch / w⌉ · t(inner) · g(w)
+// where t(i) is the time of one transform threaded i ways, measured alone,
+// and g(w) the slowdown of one single-threaded transform while w workers
+// run at once (shared caches and memory bandwidth, thread start-up). Both
+// are measured on a short probe of FFTW_ESTIMATE plans, for i over the
+// powers of two up to `threads`; the split is logged to stderr.
+int choose_inner_threads(size_t batch, size_t length, int threads);
+
+#endif // BATCH_FFT_PARALLEL_H
@@ -0,0 +1,19 @@
+#ifndef BATCH_FFT_PFB_H
+#define BATCH_FFT_PFB_H
+
+#include "common.h"
+
+// Critically sampled polyphase filter-bank channelizer: `channels` input
+// streams are split into `length` frequency channels, producing `batch`
+// output spectra per stream from a prototype filter of `taps` × `length`
+// coefficients.
+//
+// For each tile of output frames the SIMD polyphase FIR writes its branch
+// sums straight into the output, one frame of `length` samples after the
+// other. That is the contiguous idist = length layout fftwf_plan_many_dft
+// expects, so the tile is transformed in place while still in cache, with no
+// transpose and no second pass over memory. --method separate runs the FIR
+// over everything first and the FFT afterwards, for comparison.
+int run_pfb(const Args& args);
+
+#endif // BATCH_FFT_PFB_H
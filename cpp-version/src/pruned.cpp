@@ -0,0 +1,410 @@
+#include "pruned.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+enum PrunedPath { PATH_FULL, PATH_INPUT, PATH_OUTPUT };
+
+static const char* const PATH_NAMES[] = {"full", "input", "output"};
+
+struct PrunedPlan {
+    size_t batch;
+    size_t length;          // N
+    size_t input_length;    // L: nonzero samples per signal
+    size_t bins;            // K
+    size_t first_bin;
+    size_t sub_length;      // input path: smallest divisor L' of N with L' >= L
+    size_t branches;        // input path: P = N / L'
+    size_t sub_size;        // output path: S, a divisor of N
+    size_t decimation;      // output path: Q = N / S
+    size_t tile;            // signals per full-length batch
+    size_t workers;
+    fftwf_complex* input_twiddles;      // W_N^(n·r): P rows of L'
+    fftwf_complex* output_twiddles;     // W_N^(p·k): K rows of Q
+    std::vector<fftwf_complex*> buffers;    // per worker: tile × N
+    std::vector<fftwf_complex*> spectra;    // per worker: N
+    fftwf_plan full;            // tile signals, in place
+    fftwf_plan full_single;
+    fftwf_plan input;           // P × L' contiguous, out of place
+    fftwf_plan output;          // N at stride Q -> S × Q at stride Q
+};
+
+// Smallest divisor of n that is >= m
+static size_t divisor_at_least(size_t n, size_t m) {
+    for (size_t d = std::max<size_t>(m, 1); d < n; d++) {
+        if (n % d == 0) {
+            return d;
+        }
+    }
+    return n;
+}
+
+// Output path sub-transform size minimizing Q·S·5·log2(S) + K·Q·8 FLOPs
+static size_t choose_sub_size(size_t length, size_t bins) {
+    size_t best = length;
+    double best_cost = 5.0 * length * std::log2(static_cast<double>(length));
+    for (size_t s = 1; s < length; s++) {
+        if (length % s != 0) {
+            continue;
+        }
+        double cost = 5.0 * length * std::log2(static_cast<double>(s)) +
+                      8.0 * static_cast<double>(bins) * static_cast<double>(length / s);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = s;
+        }
+    }
+    return best;
+}
+
+// W_N^e = exp(-2πi·e/N), reduced mod N in integers to keep it exact for large e
+static void twiddle(size_t e, size_t n, fftwf_complex& w) {
+    double angle = -2.0 * M_PI * static_cast<double>(e % n) / static_cast<double>(n);
+    w[0] = static_cast<float>(std::cos(angle));
+    w[1] = static_cast<float>(std::sin(angle));
+}
+
+static bool create_pruned_plan(PrunedPlan& pp, const Args& args) {
+    pp.batch = args.batch;
+    pp.length = args.length;
+    pp.input_length = args.input_length;
+    pp.bins = args.bins;
+    pp.first_bin = args.first_bin;
+
+    const size_t n = pp.length;
+    pp.sub_length = divisor_at_least(n, pp.input_length);
+    pp.branches = n / pp.sub_length;
+    pp.sub_size = choose_sub_size(n, pp.bins);
+    pp.decimation = n / pp.sub_size;
+
+    size_t signal_bytes = n * sizeof(fftwf_complex);
+    pp.tile = std::max<size_t>(1, cache_size(2) / 2 / signal_bytes);
+    pp.tile = std::min(pp.tile, pp.batch);
+    pp.workers = std::min<size_t>(static_cast<size_t>(args.threads), pp.batch);
+
+    pp.input_twiddles = fftwf_alloc_complex(n);
+    for (size_t r = 0; r < pp.branches; r++) {
+        for (size_t i = 0; i < pp.sub_length; i++) {
+            twiddle(i * r, n, pp.input_twiddles[r * pp.sub_length + i]);
+        }
+    }
+    pp.output_twiddles = fftwf_alloc_complex(pp.bins * pp.decimation);
+    for (size_t i = 0; i < pp.bins; i++) {
+        for (size_t p = 0; p < pp.decimation; p++) {
+            twiddle(p * (pp.first_bin + i), n, pp.output_twiddles[i * pp.decimation + p]);
+        }
+    }
+
+    for (size_t i = 0; i < pp.workers; i++) {
+        pp.buffers.push_back(fftwf_alloc_complex(pp.tile * n));
+        pp.spectra.push_back(fftwf_alloc_complex(n));
+    }
+
+    // Single-threaded plans, the workers run them in parallel. Planned on
+    // the scratch buffers only, so the input survives FFTW_MEASURE.
+    fftwf_plan_with_nthreads(1);
+    fftwf_complex* a = pp.buffers[0];
+    fftwf_complex* y = pp.spectra[0];
+    int nn[] = {static_cast<int>(n)};
+    pp.full = fftwf_plan_many_dft(1, nn, static_cast<int>(pp.tile),
+                                  a, NULL, 1, static_cast<int>(n),
+                                  a, NULL, 1, static_cast<int>(n), FFTW_FORWARD, FFTW_MEASURE);
+    unsigned single_flags = keeps_alignment(n) ? FFTW_MEASURE : FFTW_MEASURE | FFTW_UNALIGNED;
+    pp.full_single = fftwf_plan_many_dft(1, nn, 1, a, NULL, 1, 0, a, NULL, 1, 0,
+                                         FFTW_FORWARD, single_flags);
+
+    pp.input = NULL;
+    if (pp.sub_length < n) {
+        int nl[] = {static_cast<int>(pp.sub_length)};
+        pp.input = fftwf_plan_many_dft(1, nl, static_cast<int>(pp.branches),
+                                       a, NULL, 1, static_cast<int>(pp.sub_length),
+                                       y, NULL, 1, static_cast<int>(pp.sub_length),
+                                       FFTW_FORWARD, FFTW_MEASURE);
+    }
+
+    // Unpadded signals are read in place from the input array
+    pp.output = NULL;
+    if (pp.bins < n) {
+        unsigned flags = FFTW_MEASURE;
+        if (pp.input_length == n && !keeps_alignment(n)) {
+            flags |= FFTW_UNALIGNED;
+        }
+        int ns[] = {static_cast<int>(pp.sub_size)};
+        int q = static_cast<int>(pp.decimation);
+        pp.output = fftwf_plan_many_dft(1, ns, q, a, NULL, q, 1, y, NULL, q, 1,
+                                        FFTW_FORWARD, flags);
+    }
+    fftwf_plan_with_nthreads(args.threads);
+
+    return pp.full != NULL && pp.full_single != NULL &&
+           (pp.sub_length == n || pp.input != NULL) && (pp.bins == n || pp.output != NULL);
+}
+
+static void destroy_pruned_plan(PrunedPlan& pp) {
+    fftwf_plan plans[] = {pp.full, pp.full_single, pp.input, pp.output};
+    for (size_t i = 0; i < 4; i++) {
+        if (plans[i] != NULL) {
+            fftwf_destroy_plan(plans[i]);
+        }
+    }
+    for (size_t i = 0; i < pp.buffers.size(); i++) {
+        fftwf_free(pp.buffers[i]);
+        fftwf_free(pp.spectra[i]);
+    }
+    fftwf_free(pp.input_twiddles);
+    fftwf_free(pp.output_twiddles);
+}
+
+// Zero-padded length-N transforms of `count` signals, a tile at a time
+static void process_full(const PrunedPlan& pp, const fftwf_complex* in, fftwf_complex* out,
+                         size_t first, size_t count, fftwf_complex* a) {
+    const size_t n = pp.length;
+    const size_t l = pp.input_length;
+    for (size_t j = 0; j < count; j++) {
+        memcpy(a + j * n, in + (first + j) * l, l * sizeof(fftwf_complex));
+        memset(a + j * n + l, 0, (n - l) * sizeof(fftwf_complex));
+    }
+    if (count == pp.tile) {
+        fftwf_execute_dft(pp.full, a, a);
+    } else {
+        for (size_t j = 0; j < count; j++) {
+            fftwf_execute_dft(pp.full_single, a + j * n, a + j * n);
+        }
+    }
+    for (size_t j = 0; j < count; j++) {
+        memcpy(out + (first + j) * pp.bins, a + j * n + pp.first_bin,
+               pp.bins * sizeof(fftwf_complex));
+    }
+}
+
+// P twiddled copies of the L nonzero samples, then P length-L' transforms
+static void process_input(const PrunedPlan& pp, const fftwf_complex* in, fftwf_complex* out,
+                          size_t s, fftwf_complex* a, fftwf_complex* y) {
+    const size_t l = pp.input_length;
+    const size_t lp = pp.sub_length;
+    for (size_t r = 0; r < pp.branches; r++) {
+        multiply_complex(in + s * l, pp.input_twiddles + r * lp, a + r * lp, l);
+        memset(a + r * lp + l, 0, (lp - l) * sizeof(fftwf_complex));
+    }
+    fftwf_execute_dft(pp.input, a, y);
+
+    // Branch r holds bins r, r + P, r + 2P, ...: a blocked transpose of the
+    // P × L' result puts them in order
+    transpose(y, pp.branches, lp, lp, a, pp.branches, 0);
+    memcpy(out + s * pp.bins, a + pp.first_bin, pp.bins * sizeof(fftwf_complex));
+}
+
+// Q length-S transforms of the decimated signal, then one dot product per bin
+static void process_output(const PrunedPlan& pp, const fftwf_complex* in, fftwf_complex* out,
+                           size_t s, fftwf_complex* a, fftwf_complex* y) {
+    const size_t n = pp.length;
+    const size_t l = pp.input_length;
+    const size_t q = pp.decimation;
+    fftwf_complex* x;
+    if (l == n) {
+        x = const_cast<fftwf_complex*>(in + s * n);
+    } else {
+        memcpy(a, in + s * l, l * sizeof(fftwf_complex));
+        memset(a + l, 0, (n - l) * sizeof(fftwf_complex));
+        x = a;
+    }
+    fftwf_execute_dft(pp.output, x, y);
+
+    for (size_t i = 0; i < pp.bins; i++) {
+        size_t j = (pp.first_bin + i) % pp.sub_size;
+        complex_dot(pp.output_twiddles + i * q, y + j * q, q, out + s * pp.bins + i);
+    }
+}
+
+// Process work items id, id + workers, ... of the first `count` signals
+static void pruned_worker(const PrunedPlan& pp, PrunedPath path, const fftwf_complex* in,
+                          fftwf_complex* out, size_t count, size_t workers, size_t id) {
+    const size_t unit = path == PATH_FULL ? pp.tile : 1;
+    const size_t items = (count + unit - 1) / unit;
+    fftwf_complex* a = pp.buffers[id];
+    fftwf_complex* y = pp.spectra[id];
+
+    for (size_t t = id; t < items; t += workers) {
+        if (path == PATH_FULL) {
+            process_full(pp, in, out, t * unit, std::min(unit, count - t * unit), a);
+        } else if (path == PATH_INPUT) {
+            process_input(pp, in, out, t, a, y);
+        } else {
+            process_output(pp, in, out, t, a, y);
+        }
+    }
+}
+
+static void execute_pruned(const PrunedPlan& pp, PrunedPath path, const fftwf_complex* in,
+                           fftwf_complex* out, size_t count) {
+    const size_t unit = path == PATH_FULL ? pp.tile : 1;
+    const size_t workers = std::min(pp.workers, (count + unit - 1) / unit);
+
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < workers; id++) {
+        pool.push_back(std::thread(pruned_worker, std::cref(pp), path, in, out, count,
+                                   workers, id));
+    }
+    pruned_worker(pp, path, in, out, count, workers, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+// Time every applicable path on the first few signals and keep the fastest
+static PrunedPath select_path(const PrunedPlan& pp, const fftwf_complex* in, fftwf_complex* out) {
+    size_t probe = std::min(pp.batch, std::max<size_t>(pp.tile * pp.workers, 16));
+    PrunedPath best = PATH_FULL;
+    double best_time = 0.0;
+
+    PrunedPath paths[] = {PATH_FULL, PATH_INPUT, PATH_OUTPUT};
+    for (size_t i = 0; i < 3; i++) {
+        if ((paths[i] == PATH_INPUT && pp.input == NULL) ||
+            (paths[i] == PATH_OUTPUT && pp.output == NULL)) {
+            continue;
+        }
+        // The first pass warms the caches and the twiddle tables
+        execute_pruned(pp, paths[i], in, out, probe);
+        auto start = std::chrono::high_resolution_clock::now();
+        execute_pruned(pp, paths[i], in, out, probe);
+        auto end = std::chrono::high_resolution_clock::now();
+        double time = std::chrono::duration<double>(end - start).count();
+        if (i == 0 || time < best_time) {
+            best_time = time;
+            best = paths[i];
+        }
+    }
+    return best;
+}
+
+int run_pruned(const Args& args) {
+    Args pruned_args = args;
+    if (pruned_args.input_length == 0) {
+        pruned_args.input_length = args.length;
+    }
+    if (pruned_args.bins == 0 && args.first_bin < args.length) {
+        pruned_args.bins = args.length - args.first_bin;
+    }
+    if (pruned_args.input_length > args.length) {
+        std::cerr << "Error: --input must not exceed the transform length\n";
+        return 1;
+    }
+    if (args.first_bin + pruned_args.bins > args.length || pruned_args.bins == 0) {
+        std::cerr << "Error: --first-bin + --bins must not exceed the transform length\n";
+        return 1;
+    }
+
+    PrunedPath path = PATH_FULL;
+    bool automatic = args.method.empty() || args.method == "auto";
+    if (args.method == "input") {
+        path = PATH_INPUT;
+    } else if (args.method == "output") {
+        path = PATH_OUTPUT;
+    } else if (!automatic && args.method != "full") {
+        std::cerr << "Error: --method must be auto, full, input or output\n";
+        return 1;
+    }
+
+    const size_t l = pruned_args.input_length;
+    const size_t k = pruned_args.bins;
+    fftwf_complex* in = fftwf_alloc_complex(args.batch * l);
+    fftwf_complex* out = fftwf_alloc_complex(args.batch * k);
+    fftwf_complex* reference = fftwf_alloc_complex(args.batch * k);
+
+    // Generate sample data: two tones per signal at signal-dependent frequencies
+    for (size_t s = 0; s < args.batch; s++) {
+        double f1 = 2.0 * M_PI * static_cast<double>(1 + s % 7) / static_cast<double>(l);
+        double f2 = 2.0 * M_PI * (static_cast<double>(l / 5 + s % 11) + 0.3) / static_cast<double>(l);
+        for (size_t i = 0; i < l; i++) {
+            in[s * l + i][0] = static_cast<float>(std::cos(f1 * i) + 0.5 * std::cos(f2 * i));
+            in[s * l + i][1] = static_cast<float>(std::sin(f1 * i) - 0.5 * std::sin(f2 * i));
+        }
+    }
+
+    PrunedPlan pp;
+    if (!create_pruned_plan(pp, pruned_args)) {
+        std::cerr << "Error: FFTW could not create the pruned plans\n";
+        destroy_pruned_plan(pp);
+        fftwf_free(in);
+        fftwf_free(out);
+        fftwf_free(reference);
+        return 1;
+    }
+    if ((path == PATH_INPUT && pp.input == NULL) || (path == PATH_OUTPUT && pp.output == NULL)) {
+        std::cerr << "Error: --method " << args.method << " does not apply: "
+                  << (path == PATH_INPUT ? "--input does not pad to a proper divisor of the length"
+                                         : "all bins are kept")
+                  << "\n";
+        destroy_pruned_plan(pp);
+        fftwf_free(in);
+        fftwf_free(out);
+        fftwf_free(reference);
+        return 1;
+    }
+    if (automatic) {
+        path = select_path(pp, in, out);
+    }
+
+    // Fault the output pages in so neither timed run pays for first touch
+    memset(out, 0, args.batch * k * sizeof(fftwf_complex));
+    memset(reference, 0, args.batch * k * sizeof(fftwf_complex));
+
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_pruned(pp, path, in, out, pp.batch);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Full-length transform of the same data, for the speedup and error
+    auto full_start = std::chrono::high_resolution_clock::now();
+    execute_pruned(pp, PATH_FULL, in, reference, pp.batch);
+    auto full_end = std::chrono::high_resolution_clock::now();
+
+    // Error relative to Σ|x[n]|, the largest magnitude any bin can reach;
+    // the kept band alone may hold only sidelobes
+    float max_error = 0.0f;
+    for (size_t s = 0; s < args.batch; s++) {
+        float bound = 0.0f;
+        for (size_t i = 0; i < l; i++) {
+            bound += std::sqrt(in[s * l + i][0] * in[s * l + i][0] +
+                               in[s * l + i][1] * in[s * l + i][1]);
+        }
+        for (size_t i = s * k; i < (s + 1) * k; i++) {
+            float dr = out[i][0] - reference[i][0];
+            float di = out[i][1] - reference[i][1];
+            max_error = std::max(max_error, std::sqrt(dr * dr + di * di) / bound);
+        }
+    }
+
+    // Calculate performance metrics; GFLOPS counts the full-length transform
+    std::chrono::duration<double> duration = end - start;
+    std::chrono::duration<double> full_duration = full_end - full_start;
+    double time_ms = duration.count() * 1000.0;
+    double full_time_ms = full_duration.count() * 1000.0;
+    double gflops = calculate_flops(pp.batch, pp.length) / duration.count() / 1e9;
+
+    // Output results as CSV
+    std::cout << "batch,length,input_length,first_bin,bins,method,threads,time_ms,gflops,"
+                 "full_time_ms,speedup,max_error\n";
+    std::cout << pp.batch << "," << pp.length << "," << l << "," << pp.first_bin << "," << k << ","
+              << PATH_NAMES[path] << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(2) << gflops << ","
+              << std::fixed << std::setprecision(3) << full_time_ms << ","
+              << std::fixed << std::setprecision(2) << full_time_ms / time_ms << ","
+              << std::scientific << std::setprecision(2) << max_error << "\n";
+
+    // Cleanup
+    destroy_pruned_plan(pp);
+    fftwf_free(in);
+    fftwf_free(out);
+    fftwf_free(reference);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef BATCH_FFT_PRUNED_H
+#define BATCH_FFT_PRUNED_H
+
+#include "common.h"
+
+// Pruned batched transforms of length `length` over `batch` signals whose
+// first `input_length` samples are nonzero (the rest is zero padding), of
+// which only bins [first_bin, first_bin + bins) are kept.
+//
+// Input pruning (L nonzero samples, N = P·L): with k = r + P·q,
+//   X[r + P·q] = FFT_L(x[n]·W_N^(n·r))[q]
+// so one twiddle pass and P batched length-L transforms replace the
+// length-N one; the batched plan writes straight to stride P.
+//
+// Output pruning (K bins, N = Q·S): with n = p + Q·m,
+//   X[k] = Σ_p W_N^(p·k) · FFT_S(x[p + Q·m])[k mod S]
+// so Q batched length-S transforms of the decimated input are followed by
+// one length-Q dot product per kept bin. S is chosen by a FLOP model.
+//
+// --method auto (default) times every applicable path on a few signals
+// before the run and keeps the fastest; full, input and output force one.
+int run_pruned(const Args& args);
+
+#endif // BATCH_FFT_PRUNED_H
@@ -0,0 +1,20 @@
+#ifndef BATCH_FFT_RADAR_H
+#define BATCH_FFT_RADAR_H
+
+#include "common.h"
+
+// Range-Doppler processing of `channels` coherent processing intervals
+// (CPIs), each `batch` pulses of `length` range samples.
+//
+// Fast time: tiles of pulses go through a batched FFT, a multiply by the
+// cached matched-filter spectrum of a `taps`-sample chirp and a batched
+// inverse (pulse compression). The compressed tile is written transposed
+// into the range-major Doppler map, so the corner turn happens block by
+// block while the tile is still in cache. Slow time: one batched FFT over
+// the now contiguous pulse dimension of every range bin.
+//
+// --method strided skips the corner turn and runs the Doppler FFT as a
+// strided batch over the pulse-major data, for comparison.
+int run_radar(const Args& args);
+
+#endif // BATCH_FFT_RADAR_H
@@ -0,0 +1,22 @@
+#ifndef BATCH_FFT_RESAMPLE_H
+#define BATCH_FFT_RESAMPLE_H
+
+#include "common.h"
+
+// Band-limited resampling of `batch` complex signals of `length` N samples
+// by a rational factor --ratio p/q to M = N·p/q samples, with a fractional
+// delay per signal (signal s is delayed by --delay · (s mod 16)/16 input
+// samples).
+//
+// Each signal takes a length-N forward FFT and a length-M inverse. Between
+// them one spectrum stage copies the min(N, M) lowest frequencies into the
+// M-bin spectrum, zero-padding (up) or truncating (down), with a shared
+// Nyquist bin split or folded. The same stage multiplies by the delay's
+// linear phase e^(-2πifτ/N) and folds in the 1/N scale.
+//
+// --method fused (default) runs forward, stage and inverse per tile of
+// signals that fits in L2; --method separate makes one pass over the whole
+// batch per step. Each is timed against the other.
+int run_resample(const Args& args);
+
+#endif // BATCH_FFT_RESAMPLE_H
@@ -0,0 +1,214 @@
+#include "sizes.h"
+#include "czt.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include <fftw3.h>
+
+// Measured (FFTW 3.3, AVX-512, one thread, batches of ~4M samples): power
+// of two lengths run at 13-19 nominal GFLOPS, mixed lengths such as 1000,
+// 1536 or 3000 at about 10 and odd lengths 3^k, 5^k, 7^k at 5-6. Odd radices
+// are charged twice the radix-2 cost per log2(N), and odd lengths, which get
+// no radix-2/4 SIMD passes at all, a further 1.4x.
+static const double ODD_RADIX_WEIGHT = 2.0;
+static const double ODD_LENGTH_WEIGHT = 1.4;
+
+// FFTW has straight-line codelets for primes up to 13; above that a prime
+// factor goes through Rader's algorithm or a generic O(p²) codelet. On the
+// same machine Bluestein through the chirp-Z core beat FFTW on 127, 1009,
+// 2053, 16411 and 100003 (1.2-3x) and lost on the Fermat primes 257 and
+// 65537, whose Rader convolution is a pure power of two.
+const size_t BLUESTEIN_MIN_PRIME = 17;
+
+size_t largest_prime_factor(size_t n) {
+    size_t largest = 1;
+    for (size_t p = 2; p * p <= n; p++) {
+        while (n % p == 0) {
+            largest = p;
+            n /= p;
+        }
+    }
+    return n > 1 ? std::max(largest, n) : largest;
+}
+
+bool is_smooth(size_t n) {
+    return n > 0 && largest_prime_factor(n) <= 7;
+}
+
+size_t next_smooth(size_t n) {
+    size_t best = next_pow2(n);
+    for (size_t p7 = 1; p7 < best; p7 *= 7) {
+        for (size_t p5 = p7; p5 < best; p5 *= 5) {
+            for (size_t p3 = p5; p3 < best; p3 *= 3) {
+                size_t m = p3;
+                while (m < n) {
+                    m *= 2;
+                }
+                best = std::min(best, m);
+            }
+        }
+    }
+    return best;
+}
+
+std::string factorize(size_t n) {
+    std::ostringstream out;
+    for (size_t p = 2; p * p <= n; p++) {
+        int exponent = 0;
+        while (n % p == 0) {
+            exponent++;
+            n /= p;
+        }
+        if (exponent > 0) {
+            out << (out.tellp() > 0 ? "*" : "") << p;
+            if (exponent > 1) {
+                out << "^" << exponent;
+            }
+        }
+    }
+    if (n > 1 || out.tellp() == 0) {
+        out << (out.tellp() > 0 ? "*" : "") << n;
+    }
+    return out.str();
+}
+
+// One length-n transform through Bluestein: two padded FFTs (the filter
+// spectrum is cached), the spectrum product and the pre/post chirp products
+static double bluestein_cost(size_t n) {
+    size_t m = 2 * n - 1;
+    double padded = std::min(expected_cost(next_pow2(m)), expected_cost(next_smooth(m)));
+    return 2.0 * padded + 6.0 * static_cast<double>(next_pow2(m)) + 12.0 * static_cast<double>(n);
+}
+
+// Cost of one radix-p pass over n points: n / p butterflies of 5·p·log2(p)
+// flops, which sums to 5·n·log2(n) over the passes of a power of two
+static double pass_cost(size_t n, size_t p) {
+    double butterflies = static_cast<double>(n / p);
+    if (p >= BLUESTEIN_MIN_PRIME) {
+        return butterflies * bluestein_cost(p);
+    }
+    double weight = p == 2 ? 1.0 : ODD_RADIX_WEIGHT;
+    return butterflies * 5.0 * static_cast<double>(p) * std::log2(static_cast<double>(p)) * weight;
+}
+
+double expected_cost(size_t n) {
+    double cost = 0.0;
+    size_t rest = n;
+    for (size_t p = 2; p * p <= rest; p++) {
+        while (rest % p == 0) {
+            cost += pass_cost(n, p);
+            rest /= p;
+        }
+    }
+    if (rest > 1) {
+        cost += pass_cost(n, rest);
+    }
+    return n % 2 == 1 ? cost * ODD_LENGTH_WEIGHT : cost;
+}
+
+size_t next_fast_length(size_t n) {
+    size_t smooth = next_smooth(n);
+    size_t pow2 = next_pow2(n);
+    return expected_cost(pow2) < expected_cost(smooth) ? pow2 : smooth;
+}
+
+// For a prime n, expected_cost(n) is bluestein_cost(n) times the odd-length
+// weight, so primes always qualify; a composite such as 19·1024 keeps FFTW's
+// single radix-19 pass over 1024-point sub-transforms
+bool prefer_bluestein(size_t n) {
+    size_t p = largest_prime_factor(n);
+    return p >= BLUESTEIN_MIN_PRIME && next_pow2(p - 1) != p - 1 &&
+           bluestein_cost(n) < expected_cost(n);
+}
+
+// Time one forward transform of `batch` signals of `length` samples, -1 if
+// the plans could not be created
+static double time_transform(size_t batch, size_t length, int threads, bool bluestein) {
+    size_t total_size = batch * length;
+    fftwf_complex* data = fftwf_alloc_complex(total_size);
+
+    // Plan first, FFTW_MEASURE overwrites the array
+    ChirpZ cz;
+    fftwf_plan plan = NULL;
+    bool planned;
+    if (bluestein) {
+        planned = create_bluestein(cz, batch, length, threads);
+    } else {
+        int n[] = {static_cast<int>(length)};
+        plan = fftwf_plan_many_dft(1, n, static_cast<int>(batch),
+                                   data, NULL, 1, static_cast<int>(length),
+                                   data, NULL, 1, static_cast<int>(length),
+                                   FFTW_FORWARD, FFTW_MEASURE);
+        planned = plan != NULL;
+    }
+
+    for (size_t i = 0; i < total_size; i++) {
+        float t = static_cast<float>(i % length) / static_cast<float>(length);
+        float freq = 1.0f + static_cast<float>(i / length);
+        data[i][0] = std::cos(2.0f * M_PI * freq * t);
+        data[i][1] = 0.0f;
+    }
+
+    double time_ms = -1.0;
+    if (planned) {
+        auto start = std::chrono::high_resolution_clock::now();
+        if (bluestein) {
+            execute_chirp_z(cz, data, data);
+        } else {
+            fftwf_execute(plan);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        time_ms = std::chrono::duration<double>(end - start).count() * 1000.0;
+    }
+
+    if (bluestein) {
+        destroy_chirp_z(cz);
+    } else if (plan != NULL) {
+        fftwf_destroy_plan(plan);
+    }
+    fftwf_free(data);
+    return time_ms;
+}
+
+int run_sizes(const Args& args) {
+    const size_t n = args.length;
+    std::vector<size_t> candidates;
+    candidates.push_back(n);
+    candidates.push_back(next_smooth(n));
+    candidates.push_back(next_pow2(n));
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    const double requested_cost = expected_cost(n);
+    const size_t recommended = next_fast_length(n);
+
+    std::cout << "length,factors,largest_prime,method,model_mflop,model_ratio,threads,"
+                 "time_ms,gflops,us_per_transform,recommended\n";
+    for (size_t c = 0; c < candidates.size(); c++) {
+        size_t length = candidates[c];
+        bool bluestein = prefer_bluestein(length);
+        double time_ms = time_transform(args.batch, length, args.threads, bluestein);
+        if (time_ms < 0.0) {
+            std::cerr << "Error: could not create the plans for length " << length << "\n";
+            return 1;
+        }
+        double cost = expected_cost(length);
+        double gflops = calculate_flops(args.batch, length) / (time_ms / 1000.0) / 1e9;
+
+        std::cout << length << "," << factorize(length) << "," << largest_prime_factor(length) << ","
+                  << (bluestein ? "bluestein" : "fftw") << ","
+                  << std::fixed << std::setprecision(3) << cost / 1e6 << ","
+                  << std::fixed << std::setprecision(2) << cost / requested_cost << ","
+                  << args.threads << ","
+                  << std::fixed << std::setprecision(3) << time_ms << ","
+                  << std::fixed << std::setprecision(1) << gflops << ","
+                  << std::fixed << std::setprecision(3) << time_ms * 1000.0 / args.batch << ","
+                  << (length == recommended ? 1 : 0) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef BATCH_FFT_SIZES_H
+#define BATCH_FFT_SIZES_H
+
+#include "common.h"
+
+#include <string>
+
+// Transform-length advice for arbitrary lengths.
+//
+// FFTW is fastest on 7-smooth lengths 2^a·3^b·5^c·7^d. A larger prime factor
+// p is handled by Rader's algorithm or, for a small p, a generic O(p²)
+// codelet; both are several times slower per point. The cost model below
+// charges smooth radices 5·N·log2(N) flop-equivalents with penalties for
+// odd radices and each large prime factor a Bluestein transform of it.
+// It is meant for ranking candidate lengths, not for predicting run time.
+
+// Largest prime factor of n (1 for n <= 1)
+size_t largest_prime_factor(size_t n);
+
+// True when n has no prime factor above 7
+bool is_smooth(size_t n);
+
+// Smallest 7-smooth length >= n
+size_t next_smooth(size_t n);
+
+// Prime factorization as "2^3*5^3", "1009", ...
+std::string factorize(size_t n);
+
+// Model cost of one length-n complex transform in flop-equivalents
+double expected_cost(size_t n);
+
+// Cheaper of next_smooth(n) and next_pow2(n) under expected_cost
+size_t next_fast_length(size_t n);
+
+// Smallest prime factor that batch mode's --method auto computes through
+// Bluestein's chirp-Z convolution instead of FFTW's Rader/generic codelets
+extern const size_t BLUESTEIN_MIN_PRIME;
+
+// True when --method auto should take the Bluestein path for this length:
+// a prime factor >= BLUESTEIN_MIN_PRIME other than a Fermat prime 2^k + 1,
+// and a whole-length Bluestein transform cheaper under the model than
+// expected_cost(n)
+bool prefer_bluestein(size_t n);
+
+// Size advisor: for the requested length, the next 7-smooth length and the
+// next power of two, report factorization, model cost and measured batched
+// transform time, with the model's recommendation.
+int run_sizes(const Args& args);
+
+#endif // BATCH_FFT_SIZES_H
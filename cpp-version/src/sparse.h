@@ -0,0 +1,20 @@
+#ifndef BATCH_FFT_SPARSE_H
+#define BATCH_FFT_SPARSE_H
+
+#include "common.h"
+
+// A few DFT bins of `batch` signals of `length` samples: `bins` bins spread
+// evenly from `first_bin` to the end of the spectrum.
+//
+// The Goertzel path runs the recurrences of all bins with SIMD lanes across
+// bins and two signals per pass. Signals are fed in short blocks, each started
+// from a zero state and folded into the result with a double-precision
+// phasor, which keeps the float recurrence error at block rather than
+// signal length. The FFT path runs fftwf_plan_many_dft over tiles of signals
+// and keeps the wanted bins.
+//
+// --method auto (default) chooses by bin count and length from a crossover
+// measured on the standard size table; goertzel and fft force one path.
+int run_sparse(const Args& args);
+
+#endif // BATCH_FFT_SPARSE_H
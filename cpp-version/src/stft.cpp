@@ -0,0 +1,156 @@
+#include "stft.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fftw3.h>
+
+// Multiply a frame by a periodic cosine-sum window after the transform:
+//   X_w[k] = a0 X[k] - a1/2 (X[k-1] + X[k+1]) + a2/2 (X[k-2] + X[k+2])
+// with indices taken modulo n. Works in place on one spectrum.
+static void apply_window_spectral(fftwf_complex* x, size_t n, const CosineWindow& w) {
+    const float h1 = 0.5f * w.a1;
+    const float h2 = 0.5f * w.a2;
+
+    // Original values needed once the front of the spectrum is overwritten
+    float first_re[2] = {x[0][0], x[1][0]};
+    float first_im[2] = {x[0][1], x[1][1]};
+    float prev1_re = x[n - 1][0], prev1_im = x[n - 1][1];
+    float prev2_re = x[n - 2][0], prev2_im = x[n - 2][1];
+
+    for (size_t k = 0; k < n; k++) {
+        float cur_re = x[k][0];
+        float cur_im = x[k][1];
+        float next1_re = k + 1 < n ? x[k + 1][0] : first_re[k + 1 - n];
+        float next1_im = k + 1 < n ? x[k + 1][1] : first_im[k + 1 - n];
+        float next2_re = k + 2 < n ? x[k + 2][0] : first_re[k + 2 - n];
+        float next2_im = k + 2 < n ? x[k + 2][1] : first_im[k + 2 - n];
+
+        x[k][0] = w.a0 * cur_re - h1 * (prev1_re + next1_re) + h2 * (prev2_re + next2_re);
+        x[k][1] = w.a0 * cur_im - h1 * (prev1_im + next1_im) + h2 * (prev2_im + next2_im);
+
+        prev2_re = prev1_re; prev2_im = prev1_im;
+        prev1_re = cur_re;   prev1_im = cur_im;
+    }
+}
+
+int run_stft(const Args& args) {
+    CosineWindow window;
+    if (!parse_window(args.window, window)) {
+        std::cerr << "Error: unknown window '" << args.window << "'\n";
+        return 1;
+    }
+    bool windowed = args.window != "none" && args.window != "rect";
+    if (windowed && args.length < 4) {
+        std::cerr << "Error: windowed STFT needs a frame length of at least 4\n";
+        return 1;
+    }
+    if (args.hop == 0) {
+        std::cerr << "Error: --hop must be positive\n";
+        return 1;
+    }
+
+    const size_t frames = args.batch;
+    const size_t length = args.length;
+    const size_t hop = args.hop;
+    const size_t signal_length = (frames - 1) * hop + length;
+
+    // Frames per execution. Unwindowed frames go through in a single call;
+    // windowed ones are processed in blocks whose spectra fit in half of L2,
+    // so the window pass reads them back from cache.
+    size_t block = frames;
+    if (windowed) {
+        size_t frame_bytes = length * sizeof(fftwf_complex);
+        block = std::max<size_t>(1, cache_size(2) / 2 / frame_bytes);
+        block = std::min(block, frames);
+    }
+    size_t tail = frames % block;
+
+    // Input: each channel is one long signal. Output: frames × length per channel.
+    fftwf_complex* in = fftwf_alloc_complex(args.channels * signal_length);
+    fftwf_complex* out = fftwf_alloc_complex(args.channels * frames * length);
+
+    unsigned flags = FFTW_MEASURE;
+    if (!keeps_alignment(signal_length) || !keeps_alignment(block * hop) ||
+        !keeps_alignment(block * length) || !keeps_alignment(frames * length)) {
+        flags |= FFTW_UNALIGNED;
+    }
+
+    // Overlapping frames straight from the signal: idist = hop, odist = length.
+    // Planned before the input is generated because FFTW_MEASURE overwrites it.
+    int n[] = {static_cast<int>(length)};
+    fftwf_plan plan = fftwf_plan_many_dft(
+        1, n, static_cast<int>(block),
+        in, NULL, 1, static_cast<int>(hop),
+        out, NULL, 1, static_cast<int>(length),
+        FFTW_FORWARD, flags);
+    fftwf_plan tail_plan = NULL;
+    if (tail > 0) {
+        tail_plan = fftwf_plan_many_dft(
+            1, n, static_cast<int>(tail),
+            in, NULL, 1, static_cast<int>(hop),
+            out, NULL, 1, static_cast<int>(length),
+            FFTW_FORWARD, flags);
+    }
+    if (plan == NULL || (tail > 0 && tail_plan == NULL)) {
+        std::cerr << "Error: FFTW could not create the STFT plan\n";
+        fftwf_free(in);
+        fftwf_free(out);
+        return 1;
+    }
+
+    // Generate sample data (one sine per channel)
+    for (size_t c = 0; c < args.channels; c++) {
+        float freq = 1.0f + static_cast<float>(c);
+        for (size_t i = 0; i < signal_length; i++) {
+            float t = static_cast<float>(i) / static_cast<float>(length);
+            in[c * signal_length + i][0] = std::cos(2.0f * M_PI * freq * t);
+            in[c * signal_length + i][1] = 0.0f;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t c = 0; c < args.channels; c++) {
+        fftwf_complex* signal = in + c * signal_length;
+        fftwf_complex* spectra = out + c * frames * length;
+
+        for (size_t f = 0; f < frames; f += block) {
+            size_t count = std::min(block, frames - f);
+            fftwf_execute_dft(count == block ? plan : tail_plan,
+                              signal + f * hop, spectra + f * length);
+            if (windowed) {
+                for (size_t j = 0; j < count; j++) {
+                    apply_window_spectral(spectra + (f + j) * length, length, window);
+                }
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Calculate performance metrics
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double total_frames = static_cast<double>(args.channels * frames);
+    double frames_per_sec = total_frames / duration.count();
+    double gflops = calculate_flops(args.channels * frames, length) / duration.count() / 1e9;
+
+    // Output results as CSV
+    std::cout << "channels,frames,fft_length,hop,window,threads,time_ms,frames_per_sec,gflops\n";
+    std::cout << args.channels << "," << frames << "," << length << "," << hop << ","
+              << args.window << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << frames_per_sec << ","
+              << std::fixed << std::setprecision(0) << gflops << "\n";
+
+    // Cleanup
+    fftwf_destroy_plan(plan);
+    if (tail_plan != NULL) {
+        fftwf_destroy_plan(tail_plan);
+    }
+    fftwf_free(in);
+    fftwf_free(out);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef BATCH_FFT_STFT_H
+#define BATCH_FFT_STFT_H
+
+#include "common.h"
+
+// Short-time Fourier transform of `channels` long signals, each cut into
+// `batch` frames of `length` samples advanced by `hop` samples.
+//
+// Frames are read in place from the signal (idist = hop), so overlapping
+// frames are never copied. A cosine-sum window is applied after the
+// transform as a short convolution along each spectrum, while the block of
+// frames is still in cache.
+int run_stft(const Args& args);
+
+#endif // BATCH_FFT_STFT_H
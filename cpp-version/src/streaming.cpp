@@ -0,0 +1,85 @@
+#include "streaming.h"
+#include "common.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+static fftwf_plan plan_tile(size_t length, size_t count, fftwf_complex* in, fftwf_complex* out,
+                            unsigned flags) {
+    int n[] = {static_cast<int>(length)};
+    return fftwf_plan_many_dft(
+        1, n, static_cast<int>(count),
+        in, NULL, 1, static_cast<int>(length),
+        out, NULL, 1, static_cast<int>(length),
+        FFTW_FORWARD, flags);
+}
+
+bool create_streaming_batch(StreamingBatch& sb, size_t batch, size_t length, int threads) {
+    sb.batch = batch;
+    sb.length = length;
+    size_t signal_bytes = length * sizeof(fftwf_complex);
+    sb.tile = std::max<size_t>(1, cache_size(2) / 2 / signal_bytes);
+    sb.tile = std::min(sb.tile, batch);
+    size_t tiles = (batch + sb.tile - 1) / sb.tile;
+    sb.workers = std::min<size_t>(static_cast<size_t>(threads), tiles);
+    for (size_t i = 0; i < sb.workers; i++) {
+        sb.staging.push_back(fftwf_alloc_complex(sb.tile * length));
+    }
+
+    // Input tiles start tile * length samples apart
+    unsigned flags = FFTW_MEASURE;
+    if (!keeps_alignment(sb.tile * length)) {
+        flags |= FFTW_UNALIGNED;
+    }
+
+    // Planned on scratch input so measuring does not clobber the caller's
+    // data; single-threaded, the workers run it in parallel
+    fftwf_complex* scratch = fftwf_alloc_complex(sb.tile * length);
+    fftwf_plan_with_nthreads(1);
+    size_t tail = batch % sb.tile;
+    sb.plan = plan_tile(length, sb.tile, scratch, sb.staging[0], flags);
+    sb.tail_plan = tail > 0 ? plan_tile(length, tail, scratch, sb.staging[0], flags) : NULL;
+    fftwf_plan_with_nthreads(threads);
+    fftwf_free(scratch);
+    return sb.plan != NULL && (tail == 0 || sb.tail_plan != NULL);
+}
+
+void destroy_streaming_batch(StreamingBatch& sb) {
+    if (sb.plan != NULL) {
+        fftwf_destroy_plan(sb.plan);
+    }
+    if (sb.tail_plan != NULL) {
+        fftwf_destroy_plan(sb.tail_plan);
+    }
+    for (size_t i = 0; i < sb.staging.size(); i++) {
+        fftwf_free(sb.staging[i]);
+    }
+    sb.staging.clear();
+}
+
+// Tiles id, id + workers, ...: transform into the staging tile, stream it out
+static void streaming_worker(const StreamingBatch& sb, const fftwf_complex* in, fftwf_complex* out,
+                             size_t id) {
+    const size_t tiles = (sb.batch + sb.tile - 1) / sb.tile;
+    fftwf_complex* staging = sb.staging[id];
+    for (size_t t = id; t < tiles; t += sb.workers) {
+        size_t first = t * sb.tile;
+        size_t count = std::min(sb.tile, sb.batch - first);
+        fftwf_complex* src = const_cast<fftwf_complex*>(in + first * sb.length);
+        fftwf_execute_dft(count == sb.tile ? sb.plan : sb.tail_plan, src, staging);
+        stream_copy(staging, out + first * sb.length, count * sb.length);
+    }
+}
+
+void execute_streaming_batch(const StreamingBatch& sb, const fftwf_complex* in, fftwf_complex* out) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < sb.workers; id++) {
+        pool.push_back(std::thread(streaming_worker, std::cref(sb), in, out, id));
+    }
+    streaming_worker(sb, in, out, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
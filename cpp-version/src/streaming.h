@@ -0,0 +1,33 @@
+#ifndef BATCH_FFT_STREAMING_H
+#define BATCH_FFT_STREAMING_H
+
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+// Out-of-place batched FFT for output that is handed on (to a writer or a
+// network stage) rather than read again soon. Tiles of signals sized to
+// half the L2 cache are transformed by fftwf_execute_dft into a per-worker
+// staging tile, which stream_copy then writes to the output with
+// non-temporal stores: the output lines skip the read for ownership and
+// do not evict the input still being transformed.
+struct StreamingBatch {
+    size_t batch;
+    size_t length;
+    size_t tile;            // signals per staging tile
+    size_t workers;         // tiles id, id + workers, ... per worker
+    std::vector<fftwf_complex*> staging;    // one tile per worker
+    fftwf_plan plan;        // input tile -> staging tile
+    fftwf_plan tail_plan;   // the last, partial tile; NULL if there is none
+};
+
+// Returns false if FFTW could not create a plan; destroy_streaming_batch
+// must still be called
+bool create_streaming_batch(StreamingBatch& sb, size_t batch, size_t length, int threads);
+
+// Transform `batch` contiguous signals from `in` into `out`
+void execute_streaming_batch(const StreamingBatch& sb, const fftwf_complex* in, fftwf_complex* out);
+
+void destroy_streaming_batch(StreamingBatch& sb);
+
+#endif // BATCH_FFT_STREAMING_H
@@ -0,0 +1,66 @@
+#include "vertical.h"
+#include "dispatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+bool vertical_supported(size_t length) {
+    return kernels().find_vertical_groups(length) != NULL;
+}
+
+bool create_vertical_batch(VerticalBatch& vb, size_t batch, size_t length, int threads) {
+    vb.groups = kernels().find_vertical_groups(length);
+    vb.batch = batch;
+    vb.length = length;
+    vb.threads = threads;
+    if (vb.groups == NULL) {
+        return false;
+    }
+
+    // Same stage order and layout as twiddle_offset in vertical_kernels.cpp
+    vb.twiddles.clear();
+    for (size_t n = length; n >= 8; n /= 4) {
+        for (size_t p = 0; p < n / 4; p++) {
+            for (size_t k = 1; k <= 3; k++) {
+                double angle = -2.0 * M_PI * static_cast<double>((k * p) % n) / static_cast<double>(n);
+                vb.twiddles.push_back(static_cast<float>(std::cos(angle)));
+                vb.twiddles.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+    }
+    return true;
+}
+
+void execute_vertical_batch(const VerticalBatch& vb, fftwf_complex* data, size_t count) {
+    const size_t lanes = VERTICAL_LANES;
+    size_t groups = count / lanes;
+    size_t workers = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(vb.threads), groups));
+
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < workers; id++) {
+        size_t first = groups * id / workers;
+        size_t last = groups * (id + 1) / workers;
+        pool.push_back(std::thread(vb.groups, data + first * lanes * vb.length, last - first,
+                                   vb.twiddles.data()));
+    }
+    vb.groups(data, groups / workers, vb.twiddles.data());
+
+    // Remaining signals, padded to a whole group with zero signals
+    size_t rest = count - groups * lanes;
+    if (rest > 0) {
+        fftwf_complex* tail = data + groups * lanes * vb.length;
+        fftwf_complex* padded = fftwf_alloc_complex(lanes * vb.length);
+        memset(padded, 0, lanes * vb.length * sizeof(fftwf_complex));
+        memcpy(padded, tail, rest * vb.length * sizeof(fftwf_complex));
+        vb.groups(padded, 1, vb.twiddles.data());
+        memcpy(tail, padded, rest * vb.length * sizeof(fftwf_complex));
+        fftwf_free(padded);
+    }
+
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef BATCH_FFT_VERTICAL_H
+#define BATCH_FFT_VERTICAL_H
+
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+// Batch-interleaved ("vertical") forward FFTs for tiny power-of-two lengths.
+// Eight signals at a time are transposed into the float lanes of AVX
+// registers, one register of real parts and one of imaginary parts per
+// sample; every butterfly then runs on all of them with plain vertical
+// arithmetic and no shuffles, and the result is transposed back. The
+// transposes are 8 × 8 register transposes of four complex samples from
+// each signal, fused with the first and last butterfly stages. The
+// transform is a radix-4 Stockham schedule templated on the length,
+// radix-2 last for odd log2 N. Only the avx2 and avx512 kernel levels have
+// it (dispatch.h).
+
+const size_t VERTICAL_LANES = 8;
+const size_t MIN_VERTICAL_LENGTH = 8;
+const size_t MAX_VERTICAL_LENGTH = 128;
+
+typedef void (*VerticalGroups)(fftwf_complex* data, size_t groups, const float* twiddles);
+
+// True if this build has the kernel for `length`
+bool vertical_supported(size_t length);
+
+struct VerticalBatch {
+    VerticalGroups groups;
+    size_t batch;
+    size_t length;
+    int threads;
+    std::vector<float> twiddles;    // w^p, w^2p, w^3p per radix-4 stage
+};
+
+// False if vertical_supported(length) is false
+bool create_vertical_batch(VerticalBatch& vb, size_t batch, size_t length, int threads);
+
+// Transform the first `count` of the contiguous signals in place; whole
+// groups are split over the threads, a partial last group goes
+// through a zero-padded copy
+void execute_vertical_batch(const VerticalBatch& vb, fftwf_complex* data, size_t count);
+
+#endif // BATCH_FFT_VERTICAL_H
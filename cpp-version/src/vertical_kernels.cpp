@@ -0,0 +1,256 @@
+#include "vertical.h"
+#include "dispatch.h"
+
+#include <algorithm>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace BATCH_FFT_ISA {
+
+#if defined(__AVX__)
+namespace {
+
+// How far ahead of the current group the next groups are prefetched
+const size_t PREFETCH_BYTES = 4096;
+
+// Float offset of the twiddles of the stage with stride s = 4^i: six
+// floats (w^p, w^2p, w^3p) for each of the n / s / 4 butterfly groups of
+// every earlier stage
+constexpr size_t twiddle_offset(size_t n, size_t s) {
+    size_t offset = 0;
+    for (size_t t = 1; t < s; t *= 4) {
+        offset += 6 * (n / t / 4);
+    }
+    return offset;
+}
+
+// In-register transpose of eight rows of eight floats; with four complex
+// samples of one signal per row, the rows come out as the real and
+// imaginary lanes of four samples in order
+inline void transpose8(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+typedef __m256 Lanes;
+
+inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+
+// (re, im) · (wr, wi) with broadcast twiddle parts
+inline void twiddle(Lanes& re, Lanes& im, float wr, float wi) {
+    Lanes vr = _mm256_set1_ps(wr);
+    Lanes vi = _mm256_set1_ps(wi);
+#if defined(__FMA__)
+    Lanes out_re = _mm256_fmsub_ps(re, vr, _mm256_mul_ps(im, vi));
+    im = _mm256_fmadd_ps(re, vi, _mm256_mul_ps(im, vr));
+#else
+    Lanes out_re = _mm256_sub_ps(_mm256_mul_ps(re, vr), _mm256_mul_ps(im, vi));
+    im = _mm256_add_ps(_mm256_mul_ps(re, vi), _mm256_mul_ps(im, vr));
+#endif
+    re = out_re;
+}
+
+// Samples 4b .. 4b + 3 of every signal of the group as rows[2j] (real
+// parts of sample 4b + j) and rows[2j + 1] (imaginary parts)
+inline void load_block(const float* group, size_t n, size_t b, Lanes* rows) {
+    for (size_t s = 0; s < 8; s++) {
+        rows[s] = _mm256_loadu_ps(group + 2 * (s * n + 4 * b));
+    }
+    transpose8(rows);
+}
+
+inline void store_block(float* group, size_t n, size_t b, const Lanes* rows) {
+    __m256 t[8];
+    for (size_t r = 0; r < 8; r++) {
+        t[r] = rows[r];
+    }
+    transpose8(t);
+    for (size_t s = 0; s < 8; s++) {
+        _mm256_storeu_ps(group + 2 * (s * n + 4 * b), t[s]);
+    }
+}
+
+// Radix-4 butterfly on samples a, b, c, d (real, imaginary register pairs);
+// outputs j = 0..3 go to y[j * step], y[j * step + 1], times w^j from the
+// six floats at w unless w is NULL
+inline void butterfly4(const Lanes* a, const Lanes* b, const Lanes* c, const Lanes* d,
+                       const float* w, Lanes* y, size_t step) {
+    Lanes apc_re = add(a[0], c[0]), apc_im = add(a[1], c[1]);
+    Lanes amc_re = sub(a[0], c[0]), amc_im = sub(a[1], c[1]);
+    Lanes bpd_re = add(b[0], d[0]), bpd_im = add(b[1], d[1]);
+    Lanes bmd_re = sub(b[0], d[0]), bmd_im = sub(b[1], d[1]);
+    Lanes y1_re = add(amc_re, bmd_im), y1_im = sub(amc_im, bmd_re);
+    Lanes y2_re = sub(apc_re, bpd_re), y2_im = sub(apc_im, bpd_im);
+    Lanes y3_re = sub(amc_re, bmd_im), y3_im = add(amc_im, bmd_re);
+    if (w != NULL) {
+        twiddle(y1_re, y1_im, w[0], w[1]);
+        twiddle(y2_re, y2_im, w[2], w[3]);
+        twiddle(y3_re, y3_im, w[4], w[5]);
+    }
+    y[0] = add(apc_re, bpd_re);
+    y[1] = add(apc_im, bpd_im);
+    y[step] = y1_re;
+    y[step + 1] = y1_im;
+    y[2 * step] = y2_re;
+    y[2 * step + 1] = y2_im;
+    y[3 * step] = y3_re;
+    y[3 * step + 1] = y3_im;
+}
+
+// Sample e of a group is the register pair v[2e], v[2e + 1]. One radix-4
+// Stockham stage:
+//   y[q + S(4p + j)] = w^(jp) · Σ_k x[q + S(p + kM)] (-i)^(jk)
+template <size_t M, size_t S>
+inline void radix4_stage(const Lanes* x, Lanes* y, const float* tw) {
+    for (size_t p = 0; p < M; p++) {
+        for (size_t q = 0; q < S; q++) {
+            butterfly4(x + 2 * (q + S * p), x + 2 * (q + S * (p + M)), x + 2 * (q + S * (p + 2 * M)),
+                       x + 2 * (q + S * (p + 3 * M)), p > 0 ? tw + 6 * p : NULL,
+                       y + 2 * (q + S * 4 * p), 2 * S);
+        }
+    }
+}
+
+// First stage (S = 1) fused with the load: the four input blocks of
+// butterflies p = 4pb .. 4pb + 3 are transposed straight into registers
+template <size_t N>
+inline void first_stage(const float* group, Lanes* y, const float* tw) {
+    constexpr size_t m = N / 4;
+    for (size_t pb = 0; pb < m / 4; pb++) {
+        Lanes in[4][8];
+        for (size_t k = 0; k < 4; k++) {
+            load_block(group, N, pb + k * m / 4, in[k]);
+        }
+        for (size_t t = 0; t < 4; t++) {
+            size_t p = 4 * pb + t;
+            butterfly4(in[0] + 2 * t, in[1] + 2 * t, in[2] + 2 * t, in[3] + 2 * t,
+                       p > 0 ? tw + 6 * p : NULL, y + 8 * p, 2);
+        }
+    }
+}
+
+// Last stages fused with the store: outputs q = 4qb .. 4qb + 3 of each j
+// are one transposed block of the result, at block qb + j·S/4
+template <size_t S>
+inline void last_radix4_stage(const Lanes* x, float* group) {
+    for (size_t qb = 0; qb < S / 4; qb++) {
+        Lanes out[4][8];
+        for (size_t t = 0; t < 4; t++) {
+            size_t q = 4 * qb + t;
+            Lanes y[8];
+            butterfly4(x + 2 * q, x + 2 * (q + S), x + 2 * (q + 2 * S), x + 2 * (q + 3 * S), NULL, y, 2);
+            for (size_t j = 0; j < 4; j++) {
+                out[j][2 * t] = y[2 * j];
+                out[j][2 * t + 1] = y[2 * j + 1];
+            }
+        }
+        for (size_t j = 0; j < 4; j++) {
+            store_block(group, 4 * S, qb + j * S / 4, out[j]);
+        }
+    }
+}
+
+// For odd log2 N: y[q] = x[q] + x[q + S], y[q + S] = x[q] - x[q + S]
+template <size_t S>
+inline void last_radix2_stage(const Lanes* x, float* group) {
+    for (size_t qb = 0; qb < S / 4; qb++) {
+        Lanes out[2][8];
+        for (size_t t = 0; t < 4; t++) {
+            size_t q = 4 * qb + t;
+            for (size_t h = 0; h < 2; h++) {
+                out[0][2 * t + h] = add(x[2 * q + h], x[2 * (q + S) + h]);
+                out[1][2 * t + h] = sub(x[2 * q + h], x[2 * (q + S) + h]);
+            }
+        }
+        store_block(group, 2 * S, qb, out[0]);
+        store_block(group, 2 * S, qb + S / 4, out[1]);
+    }
+}
+
+// Stages from stride S on, ping-ponging between `in` and `other`; the last
+// one stores the transposed result back into the group
+template <size_t N, size_t S>
+inline void stages(Lanes* in, Lanes* other, float* group, const float* tw) {
+    constexpr size_t n = N / S;
+    if constexpr (n == 2) {
+        last_radix2_stage<S>(in, group);
+    } else if constexpr (n == 4) {
+        last_radix4_stage<S>(in, group);
+    } else {
+        radix4_stage<n / 4, S>(in, other, tw + twiddle_offset(N, S));
+        stages<N, 4 * S>(other, in, group, tw);
+    }
+}
+
+// Groups of VERTICAL_LANES consecutive signals, transformed in place
+template <size_t N>
+void vertical_groups(fftwf_complex* data, size_t groups, const float* tw) {
+    Lanes x[2 * N];
+    Lanes work[2 * N];
+    constexpr size_t ahead = std::max<size_t>(1, PREFETCH_BYTES / (VERTICAL_LANES * N * sizeof(fftwf_complex)));
+    for (size_t g = 0; g < groups; g++) {
+        float* group = reinterpret_cast<float*>(data + g * VERTICAL_LANES * N);
+        // The group is read as eight interleaved streams, which the
+        // hardware prefetchers follow poorly; fetch the group about
+        // PREFETCH_BYTES ahead
+        if (g + ahead < groups) {
+            const char* next = reinterpret_cast<const char*>(group + 2 * ahead * VERTICAL_LANES * N);
+            for (size_t line = 0; line < VERTICAL_LANES * N * sizeof(fftwf_complex); line += 64) {
+                _mm_prefetch(next + line, _MM_HINT_T0);
+            }
+        }
+        if constexpr (N >= 16) {
+            first_stage<N>(group, x, tw);
+            stages<N, 4>(x, work, group, tw);
+        } else {
+            for (size_t b = 0; b < N / 4; b++) {
+                load_block(group, N, b, x + 8 * b);
+            }
+            stages<N, 1>(x, work, group, tw);
+        }
+    }
+}
+
+} // namespace
+
+VerticalGroups find_vertical_groups(size_t length) {
+    switch (length) {
+    case 8: return vertical_groups<8>;
+    case 16: return vertical_groups<16>;
+    case 32: return vertical_groups<32>;
+    case 64: return vertical_groups<64>;
+    case 128: return vertical_groups<128>;
+    default: return NULL;
+    }
+}
+#else
+VerticalGroups find_vertical_groups(size_t) {
+    return NULL;
+}
+#endif
+
+} // namespace BATCH_FFT_ISA
@@ -0,0 +1,190 @@
+#include "welch.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+struct WelchPlan {
+    size_t channels;
+    size_t frames;          // frames per channel
+    size_t length;
+    size_t hop;
+    size_t signal_length;
+    size_t tile;            // frames transformed together by one thread
+    size_t workers;
+    std::vector<float> window;
+    std::vector<fftwf_complex*> buffers;    // one tile per worker
+    std::vector<std::vector<float> > sums;  // channels × length per worker
+    fftwf_plan plan;        // in-place tile transform, shared via fftwf_execute_dft
+};
+
+static bool create_welch_plan(WelchPlan& wp, const Args& args, const CosineWindow& window) {
+    wp.channels = args.channels;
+    wp.frames = args.batch;
+    wp.length = args.length;
+    wp.hop = args.hop;
+    wp.signal_length = (wp.frames - 1) * wp.hop + wp.length;
+
+    // A tile of spectra takes at most half of L2, leaving room for the input frames
+    size_t frame_bytes = wp.length * sizeof(fftwf_complex);
+    wp.tile = std::max<size_t>(1, cache_size(2) / 2 / frame_bytes);
+    wp.tile = std::min(wp.tile, wp.frames);
+
+    size_t tiles = wp.channels * ((wp.frames + wp.tile - 1) / wp.tile);
+    wp.workers = std::min<size_t>(static_cast<size_t>(args.threads), tiles);
+
+    wp.window.resize(wp.length);
+    fill_window(window, wp.window.data(), wp.length);
+
+    for (size_t i = 0; i < wp.workers; i++) {
+        wp.buffers.push_back(fftwf_alloc_complex(wp.tile * wp.length));
+        wp.sums.push_back(std::vector<float>(wp.channels * wp.length, 0.0f));
+    }
+
+    // The workers provide the parallelism, so the plan itself is single-threaded
+    fftwf_plan_with_nthreads(1);
+    int n[] = {static_cast<int>(wp.length)};
+    wp.plan = fftwf_plan_many_dft(
+        1, n, static_cast<int>(wp.tile),
+        wp.buffers[0], NULL, 1, static_cast<int>(wp.length),
+        wp.buffers[0], NULL, 1, static_cast<int>(wp.length),
+        FFTW_FORWARD, FFTW_MEASURE);
+    fftwf_plan_with_nthreads(args.threads);
+
+    return wp.plan != NULL;
+}
+
+static void destroy_welch_plan(WelchPlan& wp) {
+    if (wp.plan != NULL) {
+        fftwf_destroy_plan(wp.plan);
+    }
+    for (size_t i = 0; i < wp.buffers.size(); i++) {
+        fftwf_free(wp.buffers[i]);
+    }
+}
+
+// Accumulate the tiles id, id + workers, ... into the worker's own sum
+static void welch_worker(WelchPlan& wp, const fftwf_complex* in, size_t id) {
+    const size_t tiles_per_channel = (wp.frames + wp.tile - 1) / wp.tile;
+    const size_t tiles = wp.channels * tiles_per_channel;
+    fftwf_complex* buffer = wp.buffers[id];
+    float* sum = wp.sums[id].data();
+
+    std::fill(wp.sums[id].begin(), wp.sums[id].end(), 0.0f);
+
+    for (size_t t = id; t < tiles; t += wp.workers) {
+        size_t c = t / tiles_per_channel;
+        size_t first = (t % tiles_per_channel) * wp.tile;
+        size_t count = std::min(wp.tile, wp.frames - first);
+        const fftwf_complex* signal = in + c * wp.signal_length;
+
+        // Window the frames into the tile; a short last tile is zero-padded
+        // so the same plan applies (zero frames contribute no power)
+        for (size_t j = 0; j < count; j++) {
+            apply_window(signal + (first + j) * wp.hop, wp.window.data(),
+                         buffer + j * wp.length, wp.length);
+        }
+        if (count < wp.tile) {
+            memset(buffer + count * wp.length, 0,
+                   (wp.tile - count) * wp.length * sizeof(fftwf_complex));
+        }
+
+        fftwf_execute_dft(wp.plan, buffer, buffer);
+
+        for (size_t j = 0; j < count; j++) {
+            accumulate_power(buffer + j * wp.length, sum + c * wp.length, wp.length);
+        }
+    }
+}
+
+// Average periodogram per channel: psd holds channels × length values
+static void execute_welch(WelchPlan& wp, const fftwf_complex* in, float* psd) {
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < wp.workers; id++) {
+        pool.push_back(std::thread(welch_worker, std::ref(wp), in, id));
+    }
+    welch_worker(wp, in, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+
+    // Reduce the per-thread sums, normalized by frame count and window power
+    double window_power = 0.0;
+    for (size_t i = 0; i < wp.length; i++) {
+        window_power += static_cast<double>(wp.window[i]) * wp.window[i];
+    }
+    float scale = static_cast<float>(1.0 / (static_cast<double>(wp.frames) * window_power));
+
+    size_t total = wp.channels * wp.length;
+    for (size_t i = 0; i < total; i++) {
+        float acc = 0.0f;
+        for (size_t id = 0; id < wp.workers; id++) {
+            acc += wp.sums[id][i];
+        }
+        psd[i] = acc * scale;
+    }
+}
+
+int run_welch(const Args& args) {
+    CosineWindow window;
+    if (!parse_window(args.window, window)) {
+        std::cerr << "Error: unknown window '" << args.window << "'\n";
+        return 1;
+    }
+    if (args.hop == 0) {
+        std::cerr << "Error: --hop must be positive\n";
+        return 1;
+    }
+
+    WelchPlan wp;
+    if (!create_welch_plan(wp, args, window)) {
+        std::cerr << "Error: FFTW could not create the Welch plan\n";
+        destroy_welch_plan(wp);
+        return 1;
+    }
+
+    fftwf_complex* in = fftwf_alloc_complex(wp.channels * wp.signal_length);
+    std::vector<float> psd(wp.channels * wp.length);
+
+    // Generate sample data (one sine per channel)
+    for (size_t c = 0; c < wp.channels; c++) {
+        float freq = 1.0f + static_cast<float>(c);
+        for (size_t i = 0; i < wp.signal_length; i++) {
+            float t = static_cast<float>(i) / static_cast<float>(wp.length);
+            in[c * wp.signal_length + i][0] = std::cos(2.0f * M_PI * freq * t);
+            in[c * wp.signal_length + i][1] = 0.0f;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_welch(wp, in, psd.data());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Calculate performance metrics
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double total_frames = static_cast<double>(wp.channels * wp.frames);
+    double frames_per_sec = total_frames / duration.count();
+    double gflops = calculate_flops(wp.channels * wp.frames, wp.length) / duration.count() / 1e9;
+
+    // Output results as CSV
+    std::cout << "channels,frames,fft_length,hop,window,threads,time_ms,frames_per_sec,gflops\n";
+    std::cout << wp.channels << "," << wp.frames << "," << wp.length << "," << wp.hop << ","
+              << args.window << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << frames_per_sec << ","
+              << std::fixed << std::setprecision(0) << gflops << "\n";
+
+    // Cleanup
+    destroy_welch_plan(wp);
+    fftwf_free(in);
+
+    return 0;
+}
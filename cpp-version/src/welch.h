@@ -0,0 +1,15 @@
+#ifndef BATCH_FFT_WELCH_H
+#define BATCH_FFT_WELCH_H
+
+#include "common.h"
+
+// Welch power spectral density: `channels` signals, each cut into `batch`
+// windowed frames of `length` samples advanced by `hop`, averaged into a
+// single |X|² spectrum per channel.
+//
+// Each thread windows a cache-sized tile of frames into its own buffer,
+// transforms it in place and adds the power into a thread-local sum. The
+// spectra never leave cache; only the per-thread sums are reduced at the end.
+int run_welch(const Args& args);
+
+#endif // BATCH_FFT_WELCH_H
@@ -0,0 +1,290 @@
+#include "xcorr.h"
+#include "kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fftw3.h>
+
+struct CorrelationPeak {
+    long lag;
+    float re;
+    float im;
+};
+
+struct XcorrPlan {
+    bool reference;         // one reference against the whole batch
+    bool peaks;             // return only the peak lag and value
+    size_t batch;
+    size_t length;
+    size_t fft_size;        // >= 2 * length - 1, so the correlation does not wrap
+    size_t lags;            // 2 * length - 1
+    size_t tile;            // signals transformed together
+    size_t workers;
+    fftwf_complex* reference_spectrum;
+    fftwf_plan reference_plan;  // in place on reference_spectrum
+    std::vector<fftwf_complex*> x_buffers;  // one tile per worker
+    std::vector<fftwf_complex*> y_buffers;  // pairs mode only
+    fftwf_plan forward;
+    fftwf_plan inverse;
+    fftwf_plan forward_tail;
+    fftwf_plan inverse_tail;
+};
+
+static fftwf_plan plan_tile(size_t fft_size, size_t count, fftwf_complex* buffer, int sign) {
+    int n[] = {static_cast<int>(fft_size)};
+    return fftwf_plan_many_dft(
+        1, n, static_cast<int>(count),
+        buffer, NULL, 1, static_cast<int>(fft_size),
+        buffer, NULL, 1, static_cast<int>(fft_size),
+        sign, FFTW_MEASURE);
+}
+
+static bool create_xcorr_plan(XcorrPlan& xp, const Args& args) {
+    xp.reference = args.reference;
+    xp.peaks = args.peaks;
+    xp.batch = args.batch;
+    xp.length = args.length;
+    xp.fft_size = next_pow2(2 * xp.length - 1);
+    xp.lags = 2 * xp.length - 1;
+
+    // Both operands of a tile stay in half of L2
+    size_t operands = xp.reference ? 1 : 2;
+    size_t signal_bytes = operands * xp.fft_size * sizeof(fftwf_complex);
+    xp.tile = std::max<size_t>(1, cache_size(2) / 2 / signal_bytes);
+    xp.tile = std::min(xp.tile, xp.batch);
+
+    size_t tiles = (xp.batch + xp.tile - 1) / xp.tile;
+    xp.workers = std::min<size_t>(static_cast<size_t>(args.threads), tiles);
+
+    xp.reference_spectrum = xp.reference ? fftwf_alloc_complex(xp.fft_size) : NULL;
+    for (size_t i = 0; i < xp.workers; i++) {
+        xp.x_buffers.push_back(fftwf_alloc_complex(xp.tile * xp.fft_size));
+        if (!xp.reference) {
+            xp.y_buffers.push_back(fftwf_alloc_complex(xp.tile * xp.fft_size));
+        }
+    }
+
+    // The workers provide the parallelism, so the plans are single-threaded
+    fftwf_plan_with_nthreads(1);
+    size_t tail = xp.batch % xp.tile;
+    xp.forward = plan_tile(xp.fft_size, xp.tile, xp.x_buffers[0], FFTW_FORWARD);
+    xp.inverse = plan_tile(xp.fft_size, xp.tile, xp.x_buffers[0], FFTW_BACKWARD);
+    xp.forward_tail = tail > 0 ? plan_tile(xp.fft_size, tail, xp.x_buffers[0], FFTW_FORWARD) : NULL;
+    xp.inverse_tail = tail > 0 ? plan_tile(xp.fft_size, tail, xp.x_buffers[0], FFTW_BACKWARD) : NULL;
+    xp.reference_plan = xp.reference ? plan_tile(xp.fft_size, 1, xp.reference_spectrum, FFTW_FORWARD) : NULL;
+    fftwf_plan_with_nthreads(args.threads);
+
+    return xp.forward != NULL && xp.inverse != NULL &&
+           (tail == 0 || (xp.forward_tail != NULL && xp.inverse_tail != NULL)) &&
+           (!xp.reference || xp.reference_plan != NULL);
+}
+
+static void destroy_xcorr_plan(XcorrPlan& xp) {
+    fftwf_plan plans[] = {xp.forward, xp.inverse, xp.forward_tail, xp.inverse_tail,
+                          xp.reference_plan};
+    for (size_t i = 0; i < 5; i++) {
+        if (plans[i] != NULL) {
+            fftwf_destroy_plan(plans[i]);
+        }
+    }
+    for (size_t i = 0; i < xp.x_buffers.size(); i++) {
+        fftwf_free(xp.x_buffers[i]);
+    }
+    for (size_t i = 0; i < xp.y_buffers.size(); i++) {
+        fftwf_free(xp.y_buffers[i]);
+    }
+    if (xp.reference_spectrum != NULL) {
+        fftwf_free(xp.reference_spectrum);
+    }
+}
+
+// Copy `count` signals into a tile, zero-padding each to the transform size
+static void load_tile(const XcorrPlan& xp, const fftwf_complex* signals, size_t count,
+                      fftwf_complex* buffer) {
+    for (size_t j = 0; j < count; j++) {
+        memcpy(buffer + j * xp.fft_size, signals + j * xp.length,
+               xp.length * sizeof(fftwf_complex));
+        memset(buffer + j * xp.fft_size + xp.length, 0,
+               (xp.fft_size - xp.length) * sizeof(fftwf_complex));
+    }
+}
+
+// Correlate tiles id, id + workers, ... Lag τ sits at index τ mod N of the
+// inverse transform; full output is written from lag -(length - 1) upward.
+static void xcorr_worker(const XcorrPlan& xp, const fftwf_complex* x, const fftwf_complex* y,
+                         fftwf_complex* out, CorrelationPeak* peaks, size_t id) {
+    const size_t n = xp.fft_size;
+    const size_t length = xp.length;
+    const size_t tiles = (xp.batch + xp.tile - 1) / xp.tile;
+    const float scale = 1.0f / static_cast<float>(n);
+    fftwf_complex* xb = xp.x_buffers[id];
+    fftwf_complex* yb = xp.reference ? NULL : xp.y_buffers[id];
+
+    for (size_t t = id; t < tiles; t += xp.workers) {
+        size_t first = t * xp.tile;
+        size_t count = std::min(xp.tile, xp.batch - first);
+        fftwf_plan forward = count == xp.tile ? xp.forward : xp.forward_tail;
+        fftwf_plan inverse = count == xp.tile ? xp.inverse : xp.inverse_tail;
+
+        load_tile(xp, x + first * length, count, xb);
+        fftwf_execute_dft(forward, xb, xb);
+
+        if (xp.reference) {
+            for (size_t j = 0; j < count; j++) {
+                multiply_conj_spectrum(xb + j * n, xp.reference_spectrum, n, scale);
+            }
+        } else {
+            load_tile(xp, y + first * length, count, yb);
+            fftwf_execute_dft(forward, yb, yb);
+            for (size_t j = 0; j < count; j++) {
+                multiply_conj_spectrum(xb + j * n, yb + j * n, n, scale);
+            }
+        }
+
+        fftwf_execute_dft(inverse, xb, xb);
+
+        for (size_t j = 0; j < count; j++) {
+            const fftwf_complex* r = xb + j * n;
+
+            if (xp.peaks) {
+                size_t positive = max_power_index(r, 0, length);
+                size_t index = positive;
+                // A single-sample signal has no negative lags to search
+                if (length > 1) {
+                    size_t negative = max_power_index(r, n - length + 1, n);
+                    float p_power = r[positive][0] * r[positive][0] + r[positive][1] * r[positive][1];
+                    float n_power = r[negative][0] * r[negative][0] + r[negative][1] * r[negative][1];
+                    if (n_power > p_power) {
+                        index = negative;
+                    }
+                }
+
+                CorrelationPeak& peak = peaks[first + j];
+                peak.lag = index < length ? static_cast<long>(index)
+                                          : static_cast<long>(index) - static_cast<long>(n);
+                peak.re = r[index][0];
+                peak.im = r[index][1];
+            } else {
+                fftwf_complex* row = out + (first + j) * xp.lags;
+                memcpy(row, r + n - length + 1, (length - 1) * sizeof(fftwf_complex));
+                memcpy(row + length - 1, r, length * sizeof(fftwf_complex));
+            }
+        }
+    }
+}
+
+static void execute_xcorr(const XcorrPlan& xp, const fftwf_complex* x, const fftwf_complex* y,
+                          fftwf_complex* out, CorrelationPeak* peaks) {
+    // Reference spectrum: computed once, shared by every signal in the batch
+    if (xp.reference) {
+        load_tile(xp, y, 1, xp.reference_spectrum);
+        fftwf_execute(xp.reference_plan);
+    }
+
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < xp.workers; id++) {
+        pool.push_back(std::thread(xcorr_worker, std::cref(xp), x, y, out, peaks, id));
+    }
+    xcorr_worker(xp, x, y, out, peaks, 0);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+// Delay injected into signal p of the generated data
+static long injected_delay(size_t p, size_t length) {
+    long span = static_cast<long>(std::max<size_t>(1, length / 2));
+    return static_cast<long>((p * 37) % static_cast<size_t>(span)) - span / 2;
+}
+
+int run_xcorr(const Args& args) {
+    XcorrPlan xp;
+    if (!create_xcorr_plan(xp, args)) {
+        std::cerr << "Error: FFTW could not create the correlation plans\n";
+        destroy_xcorr_plan(xp);
+        return 1;
+    }
+
+    const size_t length = xp.length;
+    size_t y_signals = xp.reference ? 1 : xp.batch;
+    fftwf_complex* x = fftwf_alloc_complex(xp.batch * length);
+    fftwf_complex* y = fftwf_alloc_complex(y_signals * length);
+    fftwf_complex* out = xp.peaks ? NULL : fftwf_alloc_complex(xp.batch * xp.lags);
+    std::vector<CorrelationPeak> peaks(xp.peaks ? xp.batch : 0);
+
+    // Generate sample data: complex noise for y, and each x a delayed copy of
+    // its y (or of the reference) so the correlation peak lands on a known lag
+    uint32_t state = 2463534242u;
+    for (size_t i = 0; i < y_signals * length; i++) {
+        for (int k = 0; k < 2; k++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            y[i][k] = static_cast<float>(state) / 4294967296.0f - 0.5f;
+        }
+    }
+    for (size_t p = 0; p < xp.batch; p++) {
+        const fftwf_complex* src = y + (xp.reference ? 0 : p * length);
+        long delay = injected_delay(p, length);
+        for (size_t i = 0; i < length; i++) {
+            long k = static_cast<long>(i) - delay;
+            bool inside = k >= 0 && k < static_cast<long>(length);
+            x[p * length + i][0] = inside ? src[k][0] : 0.0f;
+            x[p * length + i][1] = inside ? src[k][1] : 0.0f;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    execute_xcorr(xp, x, y, out, peaks.data());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Check the detected lags against the injected delays
+    size_t lag_errors = 0;
+    for (size_t p = 0; p < xp.batch; p++) {
+        long lag;
+        if (xp.peaks) {
+            lag = peaks[p].lag;
+        } else {
+            size_t index = max_power_index(out + p * xp.lags, 0, xp.lags);
+            lag = static_cast<long>(index) - static_cast<long>(length - 1);
+        }
+        if (lag != injected_delay(p, length)) {
+            lag_errors++;
+        }
+    }
+
+    // Calculate performance metrics
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double pairs_per_sec = static_cast<double>(xp.batch) / duration.count();
+    size_t transforms = xp.reference ? 2 * xp.batch + 1 : 3 * xp.batch;
+    double gflops = calculate_flops(transforms, xp.fft_size) / duration.count() / 1e9;
+
+    // Output results as CSV
+    std::cout << "batch,signal_length,fft_size,reference,peaks,threads,time_ms,"
+                 "pairs_per_sec,gflops,lag_errors\n";
+    std::cout << xp.batch << "," << length << "," << xp.fft_size << ","
+              << (xp.reference ? 1 : 0) << "," << (xp.peaks ? 1 : 0) << ","
+              << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << pairs_per_sec << ","
+              << std::fixed << std::setprecision(0) << gflops << ","
+              << lag_errors << "\n";
+
+    // Cleanup
+    destroy_xcorr_plan(xp);
+    fftwf_free(x);
+    fftwf_free(y);
+    if (out != NULL) {
+        fftwf_free(out);
+    }
+
+    return 0;
+}
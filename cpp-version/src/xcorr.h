@@ -0,0 +1,16 @@
+#ifndef BATCH_FFT_XCORR_H
+#define BATCH_FFT_XCORR_H
+
+#include "common.h"
+
+// Linear cross-correlation r[τ] = Σ x[n] conj(y[n - τ]) of `batch` signal
+// pairs of `length` samples, or of `batch` signals against one reference
+// (--reference), for lags -(length - 1) .. length - 1.
+//
+// Both operands go through a batched forward transform zero-padded to avoid
+// wrap-around, a fused conjugate multiply and a batched inverse. The
+// reference spectrum is computed once and reused for the whole batch. With
+// --peaks only the lag and value of the largest |r| are returned per pair.
+int run_xcorr(const Args& args);
+
+#endif // BATCH_FFT_XCORR_H
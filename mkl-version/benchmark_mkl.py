@@ -24,6 +24,18 @@ test_cases = [
     (250, 524288),  # 512K FFT
 ]
 
+# Non-power-of-two lengths: 7-smooth sizes and primes. Kept in a separate
+# CSV so the backend comparison scripts still line up row by row.
+non_pow2_cases = [
+    (1000, 1000),   # 2^3·5^3
+    (1000, 1536),   # 2^9·3
+    (1000, 3000),   # 2^3·3·5^3
+    (1000, 1009),   # prime
+    (1000, 4099),   # prime
+    (250, 65537),   # Fermat prime
+    (250, 100003),  # prime
+]
+
 thread_counts = [1, 2, 4, 8]
 NUM_RUNS = 5
 
@@ -110,6 +122,12 @@ def main():
         if result:
             results.append(result)
 
+    non_pow2_results = []
+    for batch, length in non_pow2_cases:
+        result = find_best_thread_count(batch, length)
+        if result:
+            non_pow2_results.append(result)
+
     # Write results to CSV
     output_file = 'mkl_results.csv'
     with open(output_file, 'w', newline='') as f:
@@ -117,13 +135,20 @@ def main():
         writer.writeheader()
         writer.writerows(results)
 
-    print(f"\nResults written to {output_file}", file=sys.stderr)
+    non_pow2_file = 'mkl_results_nonpow2.csv'
+    with open(non_pow2_file, 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=['batch', 'fft_length', 'threads', 'time_ms', 'gflops'])
+        writer.writeheader()
+        writer.writerows(non_pow2_results)
+
+    print(f"\nResults written to {output_file} and {non_pow2_file}", file=sys.stderr)
     print("\nSummary:", file=sys.stderr)
     print("-" * 60, file=sys.stderr)
 
-    for r in results:
-        size_str = f"{r['fft_length']//1024}K" if r['fft_length'] >= 1024 else str(r['fft_length'])
-        print(f"FFT {size_str:>5} × {r['batch']:>5}: {r['threads']}T, {r['time_ms']:>7.2f}ms, {r['gflops']:>4.0f} GFLOPS", file=sys.stderr)
+    for r in results + non_pow2_results:
+        length = r['fft_length']
+        size_str = f"{length//1024}K" if length >= 1024 and length % 1024 == 0 else str(length)
+        print(f"FFT {size_str:>6} × {r['batch']:>5}: {r['threads']}T, {r['time_ms']:>7.2f}ms, {r['gflops']:>4.0f} GFLOPS", file=sys.stderr)
 
 if __name__ == '__main__':
     main()
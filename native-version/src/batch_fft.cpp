@@ -0,0 +1,149 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <complex>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include "stockham.h"
+
+struct Args {
+    size_t batch;
+    size_t length;
+    int threads;
+};
+
+void print_usage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " -b <batch> -l <length> -t <threads>\n";
+    std::cerr << "  -b, --batch    Number of FFTs in the batch\n";
+    std::cerr << "  -l, --length   FFT transform length, a power of two from "
+              << MIN_LENGTH << " to " << MAX_LENGTH << "\n";
+    std::cerr << "  -t, --threads  Number of threads to use\n";
+}
+
+bool parse_args(int argc, char* argv[], Args& args) {
+    args.batch = 0;
+    args.length = 0;
+    args.threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--batch") == 0) && i + 1 < argc) {
+            args.batch = std::stoull(argv[++i]);
+        } else if ((strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--length") == 0) && i + 1 < argc) {
+            args.length = std::stoull(argv[++i]);
+        } else if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            args.threads = std::stoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+
+    return args.batch > 0 && args.length > 0 && args.threads > 0;
+}
+
+double calculate_flops(size_t batch, size_t length) {
+    double n = static_cast<double>(length);
+    double b = static_cast<double>(batch);
+    return b * 5.0 * n * std::log2(n);
+}
+
+// Transform signals [first, last) of the batch with the worker's own scratch
+static void fft_worker(const StockhamPlan& plan, std::complex<float>* data, size_t first, size_t last,
+                       std::complex<float>* work) {
+    for (size_t s = first; s < last; s++) {
+        stockham_forward(plan, data + s * plan.length, work);
+    }
+}
+
+// Sample data as in the other backends: signal s is cos(2π(1 + s)t)
+static std::complex<float> sample(size_t signal, size_t i, size_t length) {
+    float t = static_cast<float>(i) / static_cast<float>(length);
+    float freq = 1.0f + static_cast<float>(signal);
+    return std::complex<float>(std::cos(2.0f * M_PI * freq * t), 0.0f);
+}
+
+int main(int argc, char* argv[]) {
+    Args args;
+
+    if (!parse_args(argc, argv, args)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    StockhamPlan plan;
+    if (!create_stockham_plan(plan, args.length)) {
+        std::cerr << "Error: length must be a power of two from " << MIN_LENGTH << " to "
+                  << MAX_LENGTH << "\n";
+        return 1;
+    }
+
+    // Contiguous ranges of signals per thread, each with its own scratch
+    size_t workers = std::min<size_t>(static_cast<size_t>(args.threads), args.batch);
+    std::vector<std::vector<std::complex<float>>> work(workers, std::vector<std::complex<float>>(args.length));
+
+    // Initialize input data: batch of signals in a contiguous array
+    size_t total_size = args.batch * args.length;
+    std::vector<std::complex<float>> data(total_size);
+    for (size_t i = 0; i < total_size; i++) {
+        data[i] = sample(i / args.length, i % args.length, args.length);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < workers; id++) {
+        pool.push_back(std::thread(fft_worker, std::cref(plan), data.data(),
+                                   args.batch * id / workers, args.batch * (id + 1) / workers,
+                                   work[id].data()));
+    }
+    fft_worker(plan, data.data(), 0, args.batch / workers, work[0].data());
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Check the first and last signal against a direct double-precision
+    // DFT, relative to the largest reference bin
+    const size_t n = args.length;
+    std::vector<std::complex<double>> roots(n);
+    for (size_t i = 0; i < n; i++) {
+        roots[i] = std::polar(1.0, -2.0 * M_PI * static_cast<double>(i) / static_cast<double>(n));
+    }
+    double max_error = 0.0;
+    double largest = 0.0;
+    size_t check_signals[] = {0, args.batch - 1};
+    for (size_t c = 0; c < 2; c++) {
+        size_t s = check_signals[c];
+        for (size_t k = 0; k < n; k++) {
+            std::complex<double> reference = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                std::complex<float> x = sample(s, i, n);
+                reference += std::complex<double>(x.real(), x.imag()) * roots[(k * i) % n];
+            }
+            std::complex<float> y = data[s * n + k];
+            largest = std::max(largest, std::abs(reference));
+            max_error = std::max(max_error, std::abs(std::complex<double>(y.real(), y.imag()) - reference));
+        }
+    }
+    max_error /= largest;
+
+    // Calculate performance metrics
+    std::chrono::duration<double> duration = end - start;
+    double time_ms = duration.count() * 1000.0;
+    double flops = calculate_flops(args.batch, args.length);
+    double gflops = flops / duration.count() / 1e9;
+
+    // Output results as CSV
+    std::cout << "batch,fft_length,threads,time_ms,gflops,isa,max_error\n";
+    std::cout << args.batch << "," << args.length << "," << args.threads << ","
+              << std::fixed << std::setprecision(3) << time_ms << ","
+              << std::fixed << std::setprecision(0) << gflops << ","
+              << stockham_isa() << ","
+              << std::scientific << std::setprecision(2) << max_error << "\n";
+
+    return 0;
+}
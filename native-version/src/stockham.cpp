@@ -0,0 +1,280 @@
+#include "stockham.h"
+
+#include <cmath>
+#include <cstring>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+bool create_stockham_plan(StockhamPlan& plan, size_t length) {
+    if (length < MIN_LENGTH || length > MAX_LENGTH || (length & (length - 1)) != 0) {
+        return false;
+    }
+    plan.length = length;
+    plan.radix4_stages = 0;
+    plan.twiddles.clear();
+
+    size_t n = length;
+    while (n >= 4) {
+        size_t m = n / 4;
+        for (size_t k = 1; k <= 3; k++) {
+            for (size_t p = 0; p < m; p++) {
+                double angle = -2.0 * M_PI * static_cast<double>(k * p) / static_cast<double>(n);
+                plan.twiddles.push_back(std::complex<float>(static_cast<float>(std::cos(angle)),
+                                                            static_cast<float>(std::sin(angle))));
+            }
+        }
+        plan.radix4_stages++;
+        n = m;
+    }
+    plan.radix2_last = n == 2;
+    return true;
+}
+
+const char* stockham_isa() {
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__) && defined(__FMA__)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+// Both halves of a complex value as one 64-bit lane, for broadcasting
+static inline double complex_bits(const std::complex<float>& w) {
+    double bits;
+    memcpy(&bits, &w, sizeof(bits));
+    return bits;
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+// a * w for four interleaved complex values
+static inline __m256 cmul(__m256 a, __m256 w) {
+    __m256 swapped = _mm256_permute_ps(a, 0xB1);
+    return _mm256_fmaddsub_ps(a, _mm256_moveldup_ps(w), _mm256_mul_ps(swapped, _mm256_movehdup_ps(w)));
+}
+
+// -i * x: (re, im) -> (im, -re)
+static inline __m256 mul_neg_i(__m256 x) {
+    const __m256 odd_sign = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+    return _mm256_xor_ps(_mm256_permute_ps(x, 0xB1), odd_sign);
+}
+
+// Radix-4 butterfly on four vectors, results in place of a, b, c, d
+static inline void butterfly4(__m256& a, __m256& b, __m256& c, __m256& d) {
+    __m256 apc = _mm256_add_ps(a, c);
+    __m256 amc = _mm256_sub_ps(a, c);
+    __m256 bpd = _mm256_add_ps(b, d);
+    __m256 jbmd = mul_neg_i(_mm256_sub_ps(b, d));
+    a = _mm256_add_ps(apc, bpd);
+    b = _mm256_add_ps(amc, jbmd);
+    c = _mm256_sub_ps(apc, bpd);
+    d = _mm256_sub_ps(amc, jbmd);
+}
+
+// The same followed by the twiddles w1, w2, w3 on outputs 1, 2 and 3
+static inline void butterfly4(__m256& a, __m256& b, __m256& c, __m256& d,
+                              __m256 w1, __m256 w2, __m256 w3) {
+    butterfly4(a, b, c, d);
+    b = cmul(b, w1);
+    c = cmul(c, w2);
+    d = cmul(d, w3);
+}
+#endif
+
+#if defined(__AVX512F__)
+static inline __m512 cmul(__m512 a, __m512 w) {
+    __m512 swapped = _mm512_permute_ps(a, 0xB1);
+    return _mm512_fmaddsub_ps(a, _mm512_moveldup_ps(w), _mm512_mul_ps(swapped, _mm512_movehdup_ps(w)));
+}
+
+static inline __m512 mul_neg_i(__m512 x) {
+    const __m512i odd_sign = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_permute_ps(x, 0xB1)), odd_sign));
+}
+
+static inline void butterfly4(__m512& a, __m512& b, __m512& c, __m512& d) {
+    __m512 apc = _mm512_add_ps(a, c);
+    __m512 amc = _mm512_sub_ps(a, c);
+    __m512 bpd = _mm512_add_ps(b, d);
+    __m512 jbmd = mul_neg_i(_mm512_sub_ps(b, d));
+    a = _mm512_add_ps(apc, bpd);
+    b = _mm512_add_ps(amc, jbmd);
+    c = _mm512_sub_ps(apc, bpd);
+    d = _mm512_sub_ps(amc, jbmd);
+}
+
+static inline void butterfly4(__m512& a, __m512& b, __m512& c, __m512& d,
+                              __m512 w1, __m512 w2, __m512 w3) {
+    butterfly4(a, b, c, d);
+    b = cmul(b, w1);
+    c = cmul(c, w2);
+    d = cmul(d, w3);
+}
+#endif
+
+// y[q + s(4p + j)] = w^(jp) · Σ_k x[q + s(p + km)] (-i)^(jk), p < m, q < s.
+// With m = 1 every q reads and writes the same four values, so the last
+// stage may run in place (x == y). The twiddles of p = 0 are 1 and skipped,
+// which leaves the last stage without multiplies.
+static void radix4_stage(const std::complex<float>* x, std::complex<float>* y, size_t m, size_t s,
+                         const std::complex<float>* w1, const std::complex<float>* w2,
+                         const std::complex<float>* w3) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    float* yf = reinterpret_cast<float*>(y);
+#if defined(__AVX512F__)
+    if (s >= 8) {
+        for (size_t p = 0; p < m; p++) {
+            __m512 t1 = _mm512_castpd_ps(_mm512_set1_pd(complex_bits(w1[p])));
+            __m512 t2 = _mm512_castpd_ps(_mm512_set1_pd(complex_bits(w2[p])));
+            __m512 t3 = _mm512_castpd_ps(_mm512_set1_pd(complex_bits(w3[p])));
+            for (size_t q = 0; q < s; q += 8) {
+                __m512 a = _mm512_loadu_ps(xf + 2 * (q + s * p));
+                __m512 b = _mm512_loadu_ps(xf + 2 * (q + s * (p + m)));
+                __m512 c = _mm512_loadu_ps(xf + 2 * (q + s * (p + 2 * m)));
+                __m512 d = _mm512_loadu_ps(xf + 2 * (q + s * (p + 3 * m)));
+                if (p == 0) {
+                    butterfly4(a, b, c, d);
+                } else {
+                    butterfly4(a, b, c, d, t1, t2, t3);
+                }
+                _mm512_storeu_ps(yf + 2 * (q + s * 4 * p), a);
+                _mm512_storeu_ps(yf + 2 * (q + s * (4 * p + 1)), b);
+                _mm512_storeu_ps(yf + 2 * (q + s * (4 * p + 2)), c);
+                _mm512_storeu_ps(yf + 2 * (q + s * (4 * p + 3)), d);
+            }
+        }
+        return;
+    }
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+    if (s >= 4) {
+        for (size_t p = 0; p < m; p++) {
+            __m256 t1 = _mm256_castpd_ps(_mm256_set1_pd(complex_bits(w1[p])));
+            __m256 t2 = _mm256_castpd_ps(_mm256_set1_pd(complex_bits(w2[p])));
+            __m256 t3 = _mm256_castpd_ps(_mm256_set1_pd(complex_bits(w3[p])));
+            for (size_t q = 0; q < s; q += 4) {
+                __m256 a = _mm256_loadu_ps(xf + 2 * (q + s * p));
+                __m256 b = _mm256_loadu_ps(xf + 2 * (q + s * (p + m)));
+                __m256 c = _mm256_loadu_ps(xf + 2 * (q + s * (p + 2 * m)));
+                __m256 d = _mm256_loadu_ps(xf + 2 * (q + s * (p + 3 * m)));
+                if (p == 0) {
+                    butterfly4(a, b, c, d);
+                } else {
+                    butterfly4(a, b, c, d, t1, t2, t3);
+                }
+                _mm256_storeu_ps(yf + 2 * (q + s * 4 * p), a);
+                _mm256_storeu_ps(yf + 2 * (q + s * (4 * p + 1)), b);
+                _mm256_storeu_ps(yf + 2 * (q + s * (4 * p + 2)), c);
+                _mm256_storeu_ps(yf + 2 * (q + s * (4 * p + 3)), d);
+            }
+        }
+        return;
+    }
+    if (s == 1 && m % 4 == 0) {
+        // Lanes are p; the four outputs of each p are adjacent, so the
+        // 4 × 4 block of results is transposed before it is stored
+        const float* w1f = reinterpret_cast<const float*>(w1);
+        const float* w2f = reinterpret_cast<const float*>(w2);
+        const float* w3f = reinterpret_cast<const float*>(w3);
+        for (size_t p = 0; p < m; p += 4) {
+            __m256 a = _mm256_loadu_ps(xf + 2 * p);
+            __m256 b = _mm256_loadu_ps(xf + 2 * (p + m));
+            __m256 c = _mm256_loadu_ps(xf + 2 * (p + 2 * m));
+            __m256 d = _mm256_loadu_ps(xf + 2 * (p + 3 * m));
+            butterfly4(a, b, c, d, _mm256_loadu_ps(w1f + 2 * p), _mm256_loadu_ps(w2f + 2 * p),
+                       _mm256_loadu_ps(w3f + 2 * p));
+            __m256d t0 = _mm256_unpacklo_pd(_mm256_castps_pd(a), _mm256_castps_pd(b));
+            __m256d t1 = _mm256_unpackhi_pd(_mm256_castps_pd(a), _mm256_castps_pd(b));
+            __m256d t2 = _mm256_unpacklo_pd(_mm256_castps_pd(c), _mm256_castps_pd(d));
+            __m256d t3 = _mm256_unpackhi_pd(_mm256_castps_pd(c), _mm256_castps_pd(d));
+            _mm256_storeu_ps(yf + 8 * p, _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x20)));
+            _mm256_storeu_ps(yf + 8 * (p + 1), _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x20)));
+            _mm256_storeu_ps(yf + 8 * (p + 2), _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x31)));
+            _mm256_storeu_ps(yf + 8 * (p + 3), _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x31)));
+        }
+        return;
+    }
+#endif
+    for (size_t p = 0; p < m; p++) {
+        for (size_t q = 0; q < s; q++) {
+            const float* a = xf + 2 * (q + s * p);
+            const float* b = xf + 2 * (q + s * (p + m));
+            const float* c = xf + 2 * (q + s * (p + 2 * m));
+            const float* d = xf + 2 * (q + s * (p + 3 * m));
+            float apc_re = a[0] + c[0], apc_im = a[1] + c[1];
+            float amc_re = a[0] - c[0], amc_im = a[1] - c[1];
+            float bpd_re = b[0] + d[0], bpd_im = b[1] + d[1];
+            // -i(b - d)
+            float jbmd_re = b[1] - d[1], jbmd_im = d[0] - b[0];
+
+            float u_re[4] = {apc_re + bpd_re, amc_re + jbmd_re, apc_re - bpd_re, amc_re - jbmd_re};
+            float u_im[4] = {apc_im + bpd_im, amc_im + jbmd_im, apc_im - bpd_im, amc_im - jbmd_im};
+            const std::complex<float>* w[4] = {NULL, w1 + p, w2 + p, w3 + p};
+            float* out = yf + 2 * (q + s * 4 * p);
+            out[0] = u_re[0];
+            out[1] = u_im[0];
+            for (int j = 1; j < 4; j++) {
+                float wr = w[j]->real();
+                float wi = w[j]->imag();
+                out[2 * s * j] = u_re[j] * wr - u_im[j] * wi;
+                out[2 * s * j + 1] = u_re[j] * wi + u_im[j] * wr;
+            }
+        }
+    }
+}
+
+// Last stage for odd log2(N): y[q] = x[q] + x[q + s], y[q + s] = x[q] - x[q + s]
+static void radix2_stage(const std::complex<float>* x, std::complex<float>* y, size_t s) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    float* yf = reinterpret_cast<float*>(y);
+    size_t q = 0;
+#if defined(__AVX512F__)
+    for (; q + 8 <= s; q += 8) {
+        __m512 a = _mm512_loadu_ps(xf + 2 * q);
+        __m512 b = _mm512_loadu_ps(xf + 2 * (q + s));
+        _mm512_storeu_ps(yf + 2 * q, _mm512_add_ps(a, b));
+        _mm512_storeu_ps(yf + 2 * (q + s), _mm512_sub_ps(a, b));
+    }
+#elif defined(__AVX2__) && defined(__FMA__)
+    for (; q + 4 <= s; q += 4) {
+        __m256 a = _mm256_loadu_ps(xf + 2 * q);
+        __m256 b = _mm256_loadu_ps(xf + 2 * (q + s));
+        _mm256_storeu_ps(yf + 2 * q, _mm256_add_ps(a, b));
+        _mm256_storeu_ps(yf + 2 * (q + s), _mm256_sub_ps(a, b));
+    }
+#endif
+    for (; q < s; q++) {
+        float a_re = xf[2 * q], a_im = xf[2 * q + 1];
+        float b_re = xf[2 * (q + s)], b_im = xf[2 * (q + s) + 1];
+        yf[2 * q] = a_re + b_re;
+        yf[2 * q + 1] = a_im + b_im;
+        yf[2 * (q + s)] = a_re - b_re;
+        yf[2 * (q + s) + 1] = a_im - b_im;
+    }
+}
+
+void stockham_forward(const StockhamPlan& plan, std::complex<float>* x, std::complex<float>* work) {
+    const size_t stages = plan.radix4_stages + (plan.radix2_last ? 1 : 0);
+    const std::complex<float>* twiddles = plan.twiddles.data();
+    std::complex<float>* in = x;
+    size_t n = plan.length;
+    size_t s = 1;
+
+    // Stages ping-pong between x and work; the last one (m = 1) lands in x,
+    // in place if the one before it already wrote there
+    for (size_t i = 0; i < stages; i++) {
+        std::complex<float>* out = (i + 1 == stages || in != x) ? x : work;
+        if (i < plan.radix4_stages) {
+            size_t m = n / 4;
+            radix4_stage(in, out, m, s, twiddles, twiddles + m, twiddles + 2 * m);
+            twiddles += 3 * m;
+            n = m;
+            s *= 4;
+        } else {
+            radix2_stage(in, out, s);
+        }
+        in = out;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef BATCH_FFT_STOCKHAM_H
+#define BATCH_FFT_STOCKHAM_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Shortest and longest transform the native kernels are tuned for
+const size_t MIN_LENGTH = 64;
+const size_t MAX_LENGTH = 8192;
+
+// Radix-4 Stockham autosort FFT of a power-of-two length, with one radix-2
+// stage last when log2(N) is odd. Stage i turns N/4^i-point sub-transforms
+// of stride s = 4^i into N/4^(i+1)-point ones of stride 4s; the output of
+// every stage is in natural order, so there is no bit reversal pass.
+//
+// Vectorized along q (the s independent sub-transforms, contiguous in
+// memory) once s covers a vector: AVX-512 from s = 8, AVX2/FMA from s = 4.
+// The first stage (s = 1) runs along p instead and transposes each 4 × 4
+// block of outputs in registers before storing it.
+struct StockhamPlan {
+    size_t length;
+    size_t radix4_stages;
+    bool radix2_last;
+    // Per radix-4 stage with m = N/4^(i+1): w^p, w^2p, w^3p for p < m,
+    // w = e^(-2πi/(4m)), stored as three arrays of m values
+    std::vector<std::complex<float>> twiddles;
+};
+
+// false unless the length is a power of two between MIN_LENGTH and MAX_LENGTH
+bool create_stockham_plan(StockhamPlan& plan, size_t length);
+
+// In-place forward transform of x; work holds `length` scratch values
+void stockham_forward(const StockhamPlan& plan, std::complex<float>* x, std::complex<float>* work);
+
+// Instruction set the kernels were compiled for: avx512, avx2 or scalar
+const char* stockham_isa();
+
+#endif // BATCH_FFT_STOCKHAM_H